@@ -0,0 +1,890 @@
+// headless micro-benchmarks for Pipeline<Effect>
+//
+// every case builds a synthetic workload, renders it once with a counting
+// wrapper around the effect (to know how many pixels are shaded) and then
+// times it with the plain effect. results are printed one line per case,
+// so the output of two versions can be diffed to spot regressions.
+//
+// usage: RasterBenchmark [--frames n] [--width w] [--height h] [--filter text] [--trace file] [--tune [file]]
+// --tune times a standard workload with different PipelineTuning values and
+// saves the fastest (to pipeline.cfg by default), the pipelines of later runs
+// started in the same directory read them back
+// --trace needs a PROFILER build and writes the timed frames as chrome trace json
+// a HARDWARE_COUNTERS build prints IPC and misses per pixel of one frame per case
+// (reading the counters slows the timed frames down too)
+#include "HeadlessRenderTarget.h"
+#include "Pipeline.h"
+#include "HardwareCounters.h"
+#include "SolidEffect.h"
+#include "TextureEffect.h"
+#include "DrawFrameWithPhongLightEffect.h"
+#include "WBufferCreationEffect.h"
+#include "ShadowVolumesEffect1st.h"
+#include "ShadowVolumesEffect2nd.h"
+#include "Cube.h"
+#include "FrameTimer.h"
+#include "PipelineTuning.h"
+#include "PixelOps.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace
+{
+	// same frustum the pipeline sets up in its constructor
+	constexpr float frustumHalfWidth = 1.155f;
+	constexpr float frustumHalfHeight = 0.65f;
+
+	class Settings
+	{
+	public:
+		unsigned int width = 1366u;
+		unsigned int height = 768u;
+		int frames = 20;
+		std::string filter;
+		std::string trace;
+		// output file of --tune, empty for the normal benchmark run
+		std::string tune;
+	};
+
+	// wraps an effect and counts the pixel shader invocations
+	// only used for the untimed census frame
+	template<class Base>
+	class Counted
+	{
+	public:
+		typedef typename Base::Vertex Vertex;
+		typedef typename Base::VertexShader VertexShader;
+		typedef typename Base::GeometryShader GeometryShader;
+		// the raster state of the effect, but the shader always runs so that depth
+		// and stencil only passes get their pixels counted too
+		class Traits : public EffectTraits<Base>
+		{
+		public:
+			static constexpr StencilOp stencilOp = StencilOp::Shader;
+		};
+		class PixelShader : public Base::PixelShader
+		{
+		public:
+			template<class Input, class Stencil>
+			Color operator()( const Input& in,Stencil& stencil ) const
+			{
+				count.fetch_add( 1,std::memory_order_relaxed );
+				return Base::PixelShader::operator()( in,stencil );
+			}
+		public:
+			mutable std::atomic<long long> count{ 0 };
+		};
+	public:
+		VertexShader vs;
+		GeometryShader gs;
+		PixelShader ps;
+	};
+
+	// point on the view plane at distance depth that projects on pixel (px,py)
+	Vec3 ScreenToView( const Settings& s,float px,float py,float depth )
+	{
+		return{
+			(px / float( s.width ) * 2.0f - 1.0f) * frustumHalfWidth * depth,
+			(1.0f - py / float( s.height ) * 2.0f) * frustumHalfHeight * depth,
+			-depth
+		};
+	}
+
+	// grid of screen aligned quads (two triangles each) with a side of cell pixels
+	// starting at pixel (x0,y0), front facing the camera
+	template<class V>
+	void AddQuadGrid( IndexedTriangleList<V>& list,const Settings& s,float x0,float y0,
+		int nx,int ny,float cell,float depth )
+	{
+		for( int j = 0; j < ny; j++ )
+		{
+			for( int i = 0; i < nx; i++ )
+			{
+				const float px = x0 + i * cell;
+				const float py = y0 + j * cell;
+				const size_t base = list.vertices.size();
+				V v;
+				v.pos = ScreenToView( s,px,py + cell,depth );			// bottom left
+				list.vertices.push_back( v );
+				v.pos = ScreenToView( s,px + cell,py + cell,depth );	// bottom right
+				list.vertices.push_back( v );
+				v.pos = ScreenToView( s,px,py,depth );					// top left
+				list.vertices.push_back( v );
+				v.pos = ScreenToView( s,px + cell,py,depth );			// top right
+				list.vertices.push_back( v );
+				const size_t quad[] = { 0,1,2, 1,3,2 };
+				for( size_t k : quad )
+				{
+					list.indices.push_back( base + k );
+				}
+			}
+		}
+	}
+
+	template<class V>
+	IndexedTriangleList<V> EmptyList()
+	{
+		// IndexedTriangleList asserts on empty input, start from one dummy
+		// triangle and clear it
+		IndexedTriangleList<V> list( std::vector<V>( 3 ),{ 0,1,2 } );
+		list.vertices.clear();
+		list.indices.clear();
+		return list;
+	}
+
+	// screen position based texture coordinates
+	template<class V>
+	void SetScreenTexcoords( IndexedTriangleList<V>& list,float repeat )
+	{
+		for( auto& v : list.vertices )
+		{
+			const float depth = -v.pos.z;
+			v.t = { v.pos.x / depth * repeat,v.pos.y / depth * repeat };
+		}
+	}
+
+	Surface MakeCheckerTexture( unsigned int size )
+	{
+		Surface tex( size,size );
+		for( unsigned int y = 0; y < size; y++ )
+		{
+			for( unsigned int x = 0; x < size; x++ )
+			{
+				const bool odd = ((x / 16u) + (y / 16u)) % 2u != 0u;
+				tex.PutPixel( x,y,odd ? Color( 230u,200u,40u ) : Color( 40u,60u,200u ) );
+			}
+		}
+		return tex;
+	}
+
+	template<class Effect>
+	void BindIdentityTransforms( Effect& effect )
+	{
+		effect.vs.BindRotation( Mat3::Identity() );
+		effect.vs.BindTranslation( { 0.0f,0.0f,0.0f } );
+		effect.vs.BindCameraPosition( { 0.0f,0.0f,0.0f } );
+		effect.vs.BindCameraRotation( Mat3::Identity() );
+	}
+
+	class Result
+	{
+	public:
+		std::string name;
+		long long triangles = 0;
+		long long pixels = 0;
+		double frameSeconds = 0.0;
+#ifdef PIPELINE_STATISTICS
+		PipelineStatistics statistics;
+#endif
+#ifdef HW_COUNTERS_ENABLED
+		HardwareCounters::Report counters;
+#endif
+	};
+
+	// a frame of a case renders through one or more pipelines
+	// census: untimed frame with the counting effects, returns shaded pixels
+	// frame: timed frame with the plain effects
+	class Case
+	{
+	public:
+		std::string name;
+		long long triangles;
+		std::function<long long()> census;
+		std::function<void()> frame;
+	};
+
+	Result Run( const Settings& s,const Case& c )
+	{
+		Result r;
+		r.name = c.name;
+		r.triangles = c.triangles;
+		PIPELINE_STAT( PipelineStatistics::ResetFrameTotals(); )
+		r.pixels = c.census();
+		PIPELINE_STAT( r.statistics = PipelineStatistics::FrameTotals(); )
+
+		// warm up caches and worker threads
+		c.frame();
+		c.frame();
+#ifdef HW_COUNTERS_ENABLED
+		HardwareCounters::Collect();
+		c.frame();
+		r.counters = HardwareCounters::Collect();
+#endif
+
+		std::vector<float> times;
+		times.reserve( s.frames );
+		FrameTimer ft;
+		for( int i = 0; i < s.frames; i++ )
+		{
+			PROFILE_FRAME();
+			ft.Mark();
+			c.frame();
+			times.push_back( ft.Mark() );
+		}
+		std::sort( times.begin(),times.end() );
+		r.frameSeconds = times[times.size() / 2];
+		return r;
+	}
+
+#ifdef HW_COUNTERS_ENABLED
+	void PrintCounters( const Result& r )
+	{
+		if( !HardwareCounters::IsAvailable( HardwareCounters::Cycles ) )
+		{
+			printf( "    hw counters unavailable (perf_event_paranoid or no pmu)\n" );
+			return;
+		}
+		const HardwareCounters::Values total = r.counters.Total();
+		const double pixels = double( std::max( r.pixels,1ll ) );
+		printf( "    IPC %.2f | cycles/pixel",total.Ratio( HardwareCounters::Instructions,HardwareCounters::Cycles ) );
+		for( int s = 0; s < HardwareCounters::nStages; s++ )
+		{
+			const HardwareCounters::Values& v = r.counters.stages[s];
+			printf( " %s %.1f (IPC %.2f)",HardwareCounters::GetStageName( HardwareCounters::Stage( s ) ),
+				v.counts[HardwareCounters::Cycles] / pixels,v.Ratio( HardwareCounters::Instructions,HardwareCounters::Cycles ) );
+		}
+		printf( " | per pixel: L1D miss %.3f LLC miss %.3f branch miss %.3f\n",
+			total.counts[HardwareCounters::L1DMisses] / pixels,
+			total.counts[HardwareCounters::LLCMisses] / pixels,
+			total.counts[HardwareCounters::BranchMisses] / pixels );
+	}
+#endif
+
+	void Print( const Result& r )
+	{
+		const double ms = r.frameSeconds * 1000.0;
+		const double mtris = r.triangles / r.frameSeconds / 1.0e6;
+		const double mpix = r.pixels / r.frameSeconds / 1.0e6;
+		const double nsPerPixel = r.pixels > 0 ? r.frameSeconds * 1.0e9 / r.pixels : 0.0;
+		printf( "%-34s %10lld %12lld %10.3f %10.2f %10.2f %10.3f\n",
+			r.name.c_str(),r.triangles,r.pixels,ms,mtris,mpix,nsPerPixel );
+#ifdef PIPELINE_STATISTICS
+		const PipelineStatistics& st = r.statistics;
+		printf( "    vs %lld | tris %lld culled %lld rejected %lld clipped %lld -> %lld | px tested %lld passed %lld shaded %lld\n",
+			st.verticesShaded,st.trianglesAssembled,st.trianglesBackfaceCulled,st.trianglesTriviallyRejected,
+			st.trianglesClipped,st.subTrianglesGenerated,st.pixelsDepthTested,st.pixelsDepthPassed,st.pixelsShaded );
+#endif
+#ifdef HW_COUNTERS_ENABLED
+		PrintCounters( r );
+#endif
+		fflush( stdout );
+	}
+
+	// everything one pipeline needs to be benchmarked on its own
+	template<class Effect>
+	class SinglePipelineCase
+	{
+	public:
+		SinglePipelineCase( const Settings& s,IndexedTriangleList<typename Effect::Vertex> list,
+			std::function<void( Effect& )> setup,std::function<void( Counted<Effect>& )> setupCounted,
+			const PipelineState& state )
+			:
+			rt( s.width,s.height ),
+			dsb( s.width,s.height ),
+			pipeline( rt,dsb ),
+			counted( rt,dsb ),
+			list( std::move( list ) ),
+			state( state )
+		{
+			setup( pipeline.effect );
+			setupCounted( counted.effect );
+		}
+		long long Census()
+		{
+			counted.effect.ps.count = 0;
+			rt.BeginFrame();
+			counted.BeginFrame();
+			counted.switchState( state );
+			counted.Draw( list );
+			return counted.effect.ps.count;
+		}
+		void Frame()
+		{
+			rt.BeginFrame();
+			pipeline.BeginFrame();
+			pipeline.switchState( state );
+			pipeline.Draw( list );
+			rt.EndFrame();
+		}
+		long long Triangles() const
+		{
+			return (long long)(list.indices.size() / 3);
+		}
+	private:
+		HeadlessRenderTarget rt;
+		DepthStencilBuffer dsb;
+		Pipeline<Effect> pipeline;
+		Pipeline<Counted<Effect>> counted;
+		IndexedTriangleList<typename Effect::Vertex> list;
+		PipelineState state;
+	};
+
+	template<class Effect,class Setup>
+	Case MakeCase( const Settings& s,const std::string& name,IndexedTriangleList<typename Effect::Vertex> list,
+		Setup setup,const PipelineState& state = PipelineState() )
+	{
+		auto pCase = std::make_shared<SinglePipelineCase<Effect>>( s,std::move( list ),
+			[setup]( Effect& e ) { setup( e ); },
+			[setup]( Counted<Effect>& e ) { setup( e ); },
+			state );
+		Case c;
+		c.name = name;
+		c.triangles = pCase->Triangles();
+		c.census = [pCase]() { return pCase->Census(); };
+		c.frame = [pCase]() { pCase->Frame(); };
+		return c;
+	}
+
+	// vertex shading on its own, without any of the stages after it
+	std::vector<Case> VertexStage( const Settings& s )
+	{
+		auto list = std::make_shared<IndexedTriangleList<DrawFrameWithPhongLight::Vertex>>( EmptyList<DrawFrameWithPhongLight::Vertex>() );
+		AddQuadGrid( *list,s,0.0f,0.0f,256,256,float( s.width ) / 256.0f,2.0f );
+		auto effect = std::make_shared<DrawFrameWithPhongLight>();
+		BindIdentityTransforms( *effect );
+		effect->vs.BindLightSourcePosition( { 0.0f,0.0f,0.0f } );
+		Case c;
+		c.name = "stage/vertex-shader-phong";
+		c.triangles = (long long)(list->indices.size() / 3);
+		c.census = []() { return 0ll; };
+		c.frame = [list,effect]()
+		{
+			const auto out = effect->vs( list->vertices,list->indices );
+			(void)out;
+		};
+		return{ c };
+	}
+
+	// a million triangles of a quarter pixel, few have a pixel center so the
+	// vertex shader, assembly and clipping make most of the frame
+	std::vector<Case> FrontEnd( const Settings& s )
+	{
+		auto list = EmptyList<SolidEffect::Vertex>();
+		AddQuadGrid( list,s,0.0f,0.0f,1024,512,0.25f,2.0f );
+		for( auto& v : list.vertices )
+		{
+			v.color = Colors::White;
+		}
+		return{ MakeCase<SolidEffect>( s,"stage/front-end-1m",std::move( list ),
+			[]( auto& e ) { BindIdentityTransforms( e ); } ) };
+	}
+
+	// triangles of about size*size/2 pixels, capped so that tiny sizes stay fast
+	std::vector<Case> TriangleSizeSweep( const Settings& s )
+	{
+		std::vector<Case> cases;
+		const float sizes[] = { 0.5f,1.0f,2.0f,4.0f,8.0f,16.0f,32.0f,64.0f,128.0f,256.0f };
+		const long long maxQuads = 100000;
+		for( float size : sizes )
+		{
+			int nx = std::max( 1,int( float( s.width ) / size ) );
+			int ny = std::max( 1,int( float( s.height ) / size ) );
+			while( (long long)nx * ny > maxQuads )
+			{
+				nx = std::max( 1,nx / 2 );
+				ny = std::max( 1,ny / 2 );
+			}
+			auto list = EmptyList<SolidEffect::Vertex>();
+			AddQuadGrid( list,s,0.0f,0.0f,nx,ny,size,2.0f );
+			for( auto& v : list.vertices )
+			{
+				v.color = Colors::White;
+			}
+			char name[64];
+			snprintf( name,sizeof( name ),"size/%gpx",size );
+			cases.push_back( MakeCase<SolidEffect>( s,name,list,
+				[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+			// the same triangles with the fixed point edges
+			cases.push_back( MakeCase<SolidEffect>( s,std::string( name ) + "/fixed",std::move( list ),
+				[]( auto& e ) { BindIdentityTransforms( e ); },
+				PipelineState( true,false,true,false,ShadingRate::Rate1x1,true ) ) );
+		}
+		// two triangles covering the whole screen
+		auto list = EmptyList<SolidEffect::Vertex>();
+		AddQuadGrid( list,s,0.0f,0.0f,1,1,float( std::max( s.width,s.height ) ),2.0f );
+		for( auto& v : list.vertices )
+		{
+			v.color = Colors::White;
+		}
+		cases.push_back( MakeCase<SolidEffect>( s,"size/fullscreen",std::move( list ),
+			[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+		return cases;
+	}
+
+	// cameras that make most triangles cross the frustum planes
+	std::vector<Case> ClipHeavy( const Settings& s )
+	{
+		std::vector<Case> cases;
+		{
+			// floor under the camera running from behind it to beyond the far plane
+			// every row crosses the near plane or the far plane or the sides
+			auto list = EmptyList<SolidEffect::Vertex>();
+			const int n = 64;
+			const float extent = 80.0f;
+			for( int j = 0; j < n; j++ )
+			{
+				for( int i = 0; i < n; i++ )
+				{
+					const float x0 = -extent / 2.0f + extent * i / n;
+					const float x1 = -extent / 2.0f + extent * (i + 1) / n;
+					const float z0 = 8.0f - extent * j / n;
+					const float z1 = 8.0f - extent * (j + 1) / n;
+					const size_t base = list.vertices.size();
+					const Vec3 corners[] = { { x0,-1.0f,z0 },{ x1,-1.0f,z0 },{ x0,-1.0f,z1 },{ x1,-1.0f,z1 } };
+					for( const Vec3& c : corners )
+					{
+						SolidEffect::Vertex v;
+						v.pos = c;
+						v.color = (i + j) % 2 ? Colors::Gray : Colors::White;
+						list.vertices.push_back( v );
+					}
+					const size_t quad[] = { 0,1,2, 1,3,2 };
+					for( size_t k : quad )
+					{
+						list.indices.push_back( base + k );
+					}
+				}
+			}
+			cases.push_back( MakeCase<SolidEffect>( s,"clip/floor-near-far",std::move( list ),
+				[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+		}
+		{
+			// grid eight screens wide centered on the view, most triangles are
+			// trivially rejected, the ones on the border of the screen are clipped
+			auto list = EmptyList<SolidEffect::Vertex>();
+			const float cell = float( s.width ) / 4.0f;
+			AddQuadGrid( list,s,-3.5f * float( s.width ),-3.5f * float( s.height ),32,32,cell,2.0f );
+			for( auto& v : list.vertices )
+			{
+				v.color = Colors::White;
+			}
+			cases.push_back( MakeCase<SolidEffect>( s,"clip/offscreen-guard",std::move( list ),
+				[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+		}
+		return cases;
+	}
+
+	// stacks of full screen layers, front to back (rejected by w test) and back to front
+	std::vector<Case> Overdraw( const Settings& s )
+	{
+		std::vector<Case> cases;
+		const int layerCounts[] = { 1,4,16 };
+		for( int layers : layerCounts )
+		{
+			for( int backToFront = 0; backToFront < 2; backToFront++ )
+			{
+				auto list = EmptyList<SolidEffect::Vertex>();
+				for( int l = 0; l < layers; l++ )
+				{
+					const int order = backToFront ? layers - 1 - l : l;
+					AddQuadGrid( list,s,0.0f,0.0f,8,8,float( std::max( s.width,s.height ) ) / 8.0f,
+						2.0f + 0.5f * order );
+				}
+				for( auto& v : list.vertices )
+				{
+					v.color = Colors::White;
+				}
+				char name[64];
+				snprintf( name,sizeof( name ),"overdraw/%dx-%s",layers,backToFront ? "back-to-front" : "front-to-back" );
+				cases.push_back( MakeCase<SolidEffect>( s,name,std::move( list ),
+					[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+			}
+		}
+		return cases;
+	}
+
+	// full screen grid of 32x32 pixel quads drawn with each effect
+	std::vector<Case> Effects( const Settings& s )
+	{
+		std::vector<Case> cases;
+		const float cell = 32.0f;
+		const int nx = int( (s.width + 31u) / 32u );
+		const int ny = int( (s.height + 31u) / 32u );
+		{
+			auto list = EmptyList<SolidEffect::Vertex>();
+			AddQuadGrid( list,s,0.0f,0.0f,nx,ny,cell,2.0f );
+			for( size_t i = 0; i < list.vertices.size(); i++ )
+			{
+				list.vertices[i].color = (i / 4) % 2 ? Colors::Cyan : Colors::Magenta;
+			}
+			cases.push_back( MakeCase<SolidEffect>( s,"effect/SolidEffect",std::move( list ),
+				[]( auto& e ) { BindIdentityTransforms( e ); } ) );
+		}
+		{
+			auto list = EmptyList<TextureEffect::Vertex>();
+			AddQuadGrid( list,s,0.0f,0.0f,nx,ny,cell,2.0f );
+			SetScreenTexcoords( list,2.0f );
+			// also with a perspective divide only every 8 / 16 pixels
+			const std::pair<const char*,int> spans[] = { { "",0 },{ "/span-8",8 },{ "/span-16",16 } };
+			for( const auto& span : spans )
+			{
+				cases.push_back( MakeCase<TextureEffect>( s,std::string( "effect/TextureEffect" ) + span.first,list,
+					[]( auto& e )
+					{
+						BindIdentityTransforms( e );
+						e.ps.BindTexture( MakeCheckerTexture( 256u ) );
+					},PipelineState( true,false,true,false,ShadingRate::Rate1x1,false,span.second ) ) );
+			}
+		}
+		{
+			auto list = EmptyList<DrawFrameWithPhongLight::Vertex>();
+			AddQuadGrid( list,s,0.0f,0.0f,nx,ny,cell,2.0f );
+			for( auto& v : list.vertices )
+			{
+				v.t = { v.pos.x / -v.pos.z,v.pos.y / -v.pos.z };
+			}
+			// the most expensive pixel shader, also at the coarse shading rates
+			const std::pair<const char*,ShadingRate> rates[] = {
+				{ "",ShadingRate::Rate1x1 },
+				{ "/rate-2x2",ShadingRate::Rate2x2 },
+				{ "/rate-4x4",ShadingRate::Rate4x4 }
+			};
+			for( const auto& rate : rates )
+			{
+				cases.push_back( MakeCase<DrawFrameWithPhongLight>( s,std::string( "effect/DrawFrameWithPhongLight" ) + rate.first,list,
+					[]( auto& e )
+					{
+						BindIdentityTransforms( e );
+						e.vs.BindLightSourcePosition( { 0.0f,0.0f,0.0f } );
+						e.ps.BindTexture( MakeCheckerTexture( 256u ) );
+						e.ps.BindLightSourcePosition( { 0.0f,0.0f,0.0f } );
+						e.ps.BindLightSourceDesnity( 4.0f );
+						e.ps.BindAmbientLight( 0.3f );
+						e.ps.BindShininess( 3 );
+						e.ps.BindSpecularWeight( 1.5f );
+					},PipelineState( true,false,true,false,rate.second ) ) );
+			}
+		}
+		return cases;
+	}
+
+	// the three passes of the shadow volume scenes on a cube floating over a floor
+	// each pass is timed on its own, the volume passes run on top of the w buffer
+	// filled by the first one
+	class ShadowScene
+	{
+	public:
+		ShadowScene( const Settings& s )
+			:
+			rt( s.width,s.height ),
+			dsb( s.width,s.height ),
+			list( EmptyList<DefaultVertex>() ),
+			wb( rt,dsb ),
+			sv1( rt,dsb ),
+			sv2( rt,dsb ),
+			wbCounted( rt,dsb ),
+			sv1Counted( rt,dsb ),
+			sv2Counted( rt,dsb )
+		{
+			// floor
+			const int n = 32;
+			for( int j = 0; j <= n; j++ )
+			{
+				for( int i = 0; i <= n; i++ )
+				{
+					list.vertices.push_back( DefaultVertex( { -8.0f + 16.0f * i / n,-2.0f,-2.0f - 16.0f * j / n } ) );
+				}
+			}
+			for( int j = 0; j < n; j++ )
+			{
+				for( int i = 0; i < n; i++ )
+				{
+					const size_t v0 = j * (n + 1) + i;
+					const size_t quad[] = { v0,v0 + 1,v0 + n + 1, v0 + 1,v0 + n + 2,v0 + n + 1 };
+					for( size_t k : quad )
+					{
+						list.indices.push_back( k );
+					}
+				}
+			}
+			// occluder
+			auto cube = Cube::GetPlain<DefaultVertex>( 2.0f );
+			const size_t base = list.vertices.size();
+			for( auto v : cube.vertices )
+			{
+				v.pos += { 0.0f,0.0f,-8.0f };
+				list.vertices.push_back( v );
+			}
+			for( size_t i : cube.indices )
+			{
+				list.indices.push_back( base + i );
+			}
+
+			Setup( wb.effect );
+			Setup( sv1.effect );
+			Setup( sv2.effect );
+			Setup( wbCounted.effect );
+			Setup( sv1Counted.effect );
+			Setup( sv2Counted.effect );
+		}
+		template<class Effect>
+		static void Setup( Effect& e )
+		{
+			BindIdentityTransforms( e );
+		}
+		template<class P>
+		static void SetupLight( P& pipeline )
+		{
+			pipeline.effect.vs.BindLightSourcePosition( { 1.0f,6.0f,-6.0f } );
+		}
+		// fill the w buffer up to the given pass, with the plain pipelines
+		void Prepare( int pass )
+		{
+			rt.BeginFrame();
+			wb.BeginFrame();
+			if( pass > 0 )
+			{
+				DrawPass( wb,0 );
+			}
+			if( pass > 1 )
+			{
+				DrawPass( sv1,1 );
+			}
+		}
+		template<class P>
+		void DrawPass( P& pipeline,int pass )
+		{
+			const PipelineState states[] = {
+				PipelineState( true,false,false,false ),
+				PipelineState( false,true,false,false ),
+				PipelineState( false,true,false,true )
+			};
+			pipeline.switchState( states[pass] );
+			pipeline.Draw( list );
+		}
+		Case MakePassCase( const std::shared_ptr<ShadowScene>& self,int pass )
+		{
+			const char* names[] = { "effect/WBufferCreationEffect","effect/ShadowVolumesEffect1st","effect/ShadowVolumesEffect2nd" };
+			Case c;
+			c.name = names[pass];
+			c.triangles = (long long)(list.indices.size() / 3);
+			c.census = [self,pass]()
+			{
+				self->Prepare( pass );
+				self->wbCounted.effect.ps.count = 0;
+				self->sv1Counted.effect.ps.count = 0;
+				self->sv2Counted.effect.ps.count = 0;
+				switch( pass )
+				{
+				case 0: self->DrawPass( self->wbCounted,0 ); return self->wbCounted.effect.ps.count.load();
+				case 1: self->DrawPass( self->sv1Counted,1 ); return self->sv1Counted.effect.ps.count.load();
+				default: self->DrawPass( self->sv2Counted,2 ); return self->sv2Counted.effect.ps.count.load();
+				}
+			};
+			// the frames being timed include only the pass itself
+			c.frame = [self,pass]()
+			{
+				self->Prepare( pass );
+				switch( pass )
+				{
+				case 0: self->DrawPass( self->wb,0 ); break;
+				case 1: self->DrawPass( self->sv1,1 ); break;
+				default: self->DrawPass( self->sv2,2 ); break;
+				}
+			};
+			return c;
+		}
+	public:
+		HeadlessRenderTarget rt;
+		DepthStencilBuffer dsb;
+		IndexedTriangleList<DefaultVertex> list;
+		Pipeline<WBufferCreationEffect> wb;
+		Pipeline<ShadowVolumesEffect1st> sv1;
+		Pipeline<ShadowVolumesEffect2nd> sv2;
+		Pipeline<Counted<WBufferCreationEffect>> wbCounted;
+		Pipeline<Counted<ShadowVolumesEffect1st>> sv1Counted;
+		Pipeline<Counted<ShadowVolumesEffect2nd>> sv2Counted;
+	};
+
+	std::vector<Case> ShadowVolumes( const Settings& s )
+	{
+		auto scene = std::make_shared<ShadowScene>( s );
+		ShadowScene::SetupLight( scene->sv1 );
+		ShadowScene::SetupLight( scene->sv2 );
+		ShadowScene::SetupLight( scene->sv1Counted );
+		ShadowScene::SetupLight( scene->sv2Counted );
+		std::vector<Case> cases;
+		for( int pass = 0; pass < 3; pass++ )
+		{
+			cases.push_back( scene->MakePassCase( scene,pass ) );
+		}
+		return cases;
+	}
+
+	// median frame time of the --tune workload summed over its cases: micro
+	// triangles (front end and the bands of the micro batch), mid size ones
+	// (row loops) and a view that clips most triangles
+	// the cases get built again for every call, since a pipeline reads the
+	// tuning when it is constructed
+	double TimeWorkload( const Settings& s,const PipelineTuning& tuning )
+	{
+		PipelineTuning::SetCurrent( tuning );
+		std::vector<Case> cases = TriangleSizeSweep( s );
+		const std::vector<Case> clip = ClipHeavy( s );
+		cases.insert( cases.end(),clip.begin(),clip.end() );
+		double seconds = 0.0;
+		for( const Case& c : cases )
+		{
+			if( c.name == "size/2px" || c.name == "size/32px" || c.name == "clip/floor-near-far" )
+			{
+				seconds += Run( s,c ).frameSeconds;
+			}
+		}
+		printf( "threads %2u frontEndChunk %5u microBandRows %3u %10.3f ms\n",
+			tuning.threads,tuning.frontEndChunk,tuning.microBandRows,seconds * 1000.0 );
+		fflush( stdout );
+		return seconds;
+	}
+
+	// tries the values of one member of best, keeps the fastest
+	// (a value has to win by 2% to replace the one before it, less is noise)
+	void TuneMember( const Settings& s,PipelineTuning& best,double& bestSeconds,
+		unsigned int PipelineTuning::* member,const std::vector<unsigned int>& values )
+	{
+		const PipelineTuning start = best;
+		for( unsigned int value : values )
+		{
+			if( value == start.*member )
+			{
+				continue;
+			}
+			PipelineTuning candidate = start;
+			candidate.*member = value;
+			const double seconds = TimeWorkload( s,candidate );
+			if( seconds < bestSeconds * 0.98 )
+			{
+				best = candidate;
+				bestSeconds = seconds;
+			}
+		}
+	}
+
+	// one member at a time starting from the defaults, the thread count first
+	// since the other sizes depend on it
+	int Tune( const Settings& s )
+	{
+		PipelineTuning::SetCurrent( PipelineTuning() );
+		const unsigned int allThreads = ParallelThreadCount();
+		std::vector<unsigned int> threadCounts;
+		for( unsigned int n = 1u; n < allThreads; n *= 2u )
+		{
+			threadCounts.push_back( n );
+		}
+
+		printf( "tuning at %ux%u, median of %d frames, %u threads\n",s.width,s.height,s.frames,allThreads );
+		PipelineTuning best;
+		best.width = s.width;
+		best.height = s.height;
+		double bestSeconds = TimeWorkload( s,best );
+		TuneMember( s,best,bestSeconds,&PipelineTuning::threads,threadCounts );
+		TuneMember( s,best,bestSeconds,&PipelineTuning::frontEndChunk,{ 256u,1024u,4096u } );
+		// the micro batch only runs with more than one thread
+		if( best.threads != 1u && allThreads > 1u )
+		{
+			TuneMember( s,best,bestSeconds,&PipelineTuning::microBandRows,{ 8u,16u,32u,64u } );
+		}
+
+		if( !best.Save( s.tune ) )
+		{
+			fprintf( stderr,"could not write %s\n",s.tune.c_str() );
+			return 1;
+		}
+		printf( "best: threads %u (0 is all) frontEndChunk %u microBandRows %u, %.3f ms, saved to %s\n",
+			best.threads,best.frontEndChunk,best.microBandRows,bestSeconds * 1000.0,s.tune.c_str() );
+		return 0;
+	}
+}
+
+int main( int argc,char** argv )
+{
+	Settings s;
+	for( int i = 1; i < argc; i++ )
+	{
+		const bool hasValue = i + 1 < argc;
+		if( !strcmp( argv[i],"--frames" ) && hasValue )
+		{
+			s.frames = std::max( 1,atoi( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--width" ) && hasValue )
+		{
+			s.width = (unsigned int)std::max( 16,atoi( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--height" ) && hasValue )
+		{
+			s.height = (unsigned int)std::max( 16,atoi( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--filter" ) && hasValue )
+		{
+			s.filter = argv[++i];
+		}
+		else if( !strcmp( argv[i],"--trace" ) && hasValue )
+		{
+			s.trace = argv[++i];
+		}
+		else if( !strcmp( argv[i],"--tune" ) )
+		{
+			s.tune = hasValue && argv[i + 1][0] != '-' ? argv[++i] : PipelineTuning::defaultFile;
+		}
+		else
+		{
+			fprintf( stderr,"usage: %s [--frames n] [--width w] [--height h] [--filter text] [--trace file] [--tune [file]]\n",argv[0] );
+			return 1;
+		}
+	}
+	if( !s.tune.empty() )
+	{
+		return Tune( s );
+	}
+
+	std::vector<std::function<std::vector<Case>( const Settings& )>> groups = {
+		VertexStage,FrontEnd,TriangleSizeSweep,ClipHeavy,Overdraw,Effects,ShadowVolumes
+	};
+
+	// clears and the upscaled present go through these, a kernel that is off by one
+	// would skew every checksum taken from a frame
+	if( const char* pKernels = PixelOps::CheckKernels() )
+	{
+		fprintf( stderr,"%s pixel kernels do not match the scalar ones\n",pKernels );
+		return 1;
+	}
+
+	const PipelineTuning& tuning = PipelineTuning::Current();
+	printf( "resolution %ux%u, median of %d frames, %u threads, frontEndChunk %u, microBandRows %u, pixel kernels %s\n",
+		s.width,s.height,s.frames,ParallelThreadCount(),tuning.frontEndChunk,tuning.microBandRows,PixelOps::GetKernelName() );
+	printf( "%-34s %10s %12s %10s %10s %10s %10s\n",
+		"case","triangles","pixels","ms/frame","Mtris/s","Mpix/s","ns/pixel" );
+	for( auto& group : groups )
+	{
+		for( const Case& c : group( s ) )
+		{
+			if( !s.filter.empty() && c.name.find( s.filter ) == std::string::npos )
+			{
+				continue;
+			}
+			Print( Run( s,c ) );
+		}
+	}
+
+	if( !s.trace.empty() )
+	{
+#ifdef PROFILER
+		// census and warm up frames end up in the frame before the timed ones
+		if( !Profiler::WriteChromeTrace( s.trace,0u,Profiler::GetFrame() ) )
+		{
+			fprintf( stderr,"could not write %s\n",s.trace.c_str() );
+			return 1;
+		}
+#else
+		fprintf( stderr,"--trace needs a build with PROFILER defined\n" );
+		return 1;
+#endif
+	}
+	return 0;
+}
@@ -0,0 +1,262 @@
+// headless scene macro-benchmark driven by a recorded input file
+//
+// record a camera path in the game (F8 starts / stops, writes input.rec),
+// then replay it here through the same Scene::Update / Scene::Draw calls
+// with a fixed timestep. the frame times of two runs (or two versions)
+// can be compared since every run renders exactly the same frames.
+//
+// usage: SceneReplay <input.rec> [--scene name] [--model file] [--texture file]
+//                    [--width w] [--height h] [--step seconds] [--save last.bmp] [--overlay]
+//                    [--scale s] [--budget ms]
+// --scale renders every frame at a fixed fraction of the size, --budget lets a
+// ResolutionGovernor pick the scale of every frame from the frame times
+// scenes: shadow-lit, shadow, obj-gs, skin, solid
+// builds without GDI+ read .jpg / .png textures through libjpeg / libpng when
+// cmake finds them, .bmp ones always
+#include "HeadlessRenderTarget.h"
+#include "InputRecording.h"
+#include "FrameTimer.h"
+#include "PerformanceOverlay.h"
+#include "ResolutionGovernor.h"
+#include "ShadowVolumesScene.h"
+#include "ShadowVolumesWithLightingScene.h"
+#include "CubeSkinFromObjSceneWithGS.h"
+#include "CubeSkinScene.h"
+#include "CubeSolidScene.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	class Settings
+	{
+	public:
+		std::string input;
+		std::string scene = "shadow-lit";
+		std::wstring model = L"Objects/q3rocket.obj";
+		std::wstring texture = L"Images/rocketl.jpg";
+		unsigned int width = 1366u;
+		unsigned int height = 768u;
+		float step = 1.0f / 60.0f;
+		std::wstring save;
+		bool overlay = false;
+		float scale = 1.0f;
+		// seconds, 0 for a fixed scale
+		float budget = 0.0f;
+	};
+
+	std::unique_ptr<Scene> MakeScene( const Settings& s,RenderTarget& rt )
+	{
+		if( s.scene == "shadow-lit" )
+		{
+			return std::make_unique<ShadowVolumesWithLightingScene>( rt,s.model,s.texture,0.25f );
+		}
+		if( s.scene == "shadow" )
+		{
+			return std::make_unique<ShadowVolumesScene>( rt,s.model,s.texture,0.25f );
+		}
+		if( s.scene == "obj-gs" )
+		{
+			return std::make_unique<CubeSkinFromObjSceneWithGS>( rt,s.model,s.texture,0.25f );
+		}
+		if( s.scene == "skin" )
+		{
+			return std::make_unique<CubeSkinScene>( rt,s.texture );
+		}
+		if( s.scene == "solid" )
+		{
+			return std::make_unique<CubeSolidScene>( rt );
+		}
+		return nullptr;
+	}
+
+	// nearest-rank percentile of sorted values
+	float Percentile( const std::vector<float>& sorted,float p )
+	{
+		const size_t rank = size_t( std::max( 1.0f,p / 100.0f * float( sorted.size() ) + 0.999f ) );
+		return sorted[std::min( rank,sorted.size() ) - 1u];
+	}
+
+	// fnv-1a of the last frame, equal checksums mean the runs rendered the same thing
+	unsigned int Checksum( const Surface& surface )
+	{
+		unsigned int hash = 2166136261u;
+		const unsigned char* p = reinterpret_cast<const unsigned char*>( surface.GetBufferPtrConst() );
+		for( unsigned int y = 0; y < surface.GetHeight(); y++ )
+		{
+			const unsigned char* line = p + size_t( y ) * surface.GetPitch() * sizeof( Color );
+			for( size_t i = 0; i < surface.GetWidth() * sizeof( Color ); i++ )
+			{
+				hash = (hash ^ line[i]) * 16777619u;
+			}
+		}
+		return hash;
+	}
+}
+
+int main( int argc,char** argv )
+{
+	Settings s;
+	for( int i = 1; i < argc; i++ )
+	{
+		const bool hasValue = i + 1 < argc;
+		if( !strcmp( argv[i],"--scene" ) && hasValue )
+		{
+			s.scene = argv[++i];
+		}
+		else if( !strcmp( argv[i],"--model" ) && hasValue )
+		{
+			const std::string name = argv[++i];
+			s.model = std::wstring( name.begin(),name.end() );
+		}
+		else if( !strcmp( argv[i],"--texture" ) && hasValue )
+		{
+			const std::string name = argv[++i];
+			s.texture = std::wstring( name.begin(),name.end() );
+		}
+		else if( !strcmp( argv[i],"--width" ) && hasValue )
+		{
+			s.width = (unsigned int)std::max( 16,atoi( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--height" ) && hasValue )
+		{
+			s.height = (unsigned int)std::max( 16,atoi( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--step" ) && hasValue )
+		{
+			s.step = std::max( 0.0001f,float( atof( argv[++i] ) ) );
+		}
+		else if( !strcmp( argv[i],"--save" ) && hasValue )
+		{
+			const std::string name = argv[++i];
+			s.save = std::wstring( name.begin(),name.end() );
+		}
+		else if( !strcmp( argv[i],"--scale" ) && hasValue )
+		{
+			s.scale = float( atof( argv[++i] ) );
+		}
+		else if( !strcmp( argv[i],"--budget" ) && hasValue )
+		{
+			s.budget = std::max( 0.0f,float( atof( argv[++i] ) ) / 1000.0f );
+		}
+		else if( !strcmp( argv[i],"--overlay" ) )
+		{
+			s.overlay = true;
+		}
+		else if( argv[i][0] != '-' && s.input.empty() )
+		{
+			s.input = argv[i];
+		}
+		else
+		{
+			s.input.clear();
+			break;
+		}
+	}
+	if( s.input.empty() )
+	{
+		fprintf( stderr,"usage: %s <input.rec> [--scene shadow-lit|shadow|obj-gs|skin|solid] [--model file] [--texture file]"
+			" [--width w] [--height h] [--step seconds] [--save last.bmp] [--overlay] [--scale s] [--budget ms]\n",argv[0] );
+		return 1;
+	}
+
+	try
+	{
+		InputReplay replay( s.input );
+		HeadlessRenderTarget rt( s.width,s.height );
+		std::unique_ptr<Scene> pScene = MakeScene( s,rt );
+		if( !pScene )
+		{
+			fprintf( stderr,"unknown scene %s\n",s.scene.c_str() );
+			return 1;
+		}
+		Keyboard kbd;
+		Mouse mouse;
+
+		// the recording decides how long the run is, the step how many frames it has
+		const unsigned int nFrames = (unsigned int)std::ceil( replay.GetDuration() / s.step );
+		std::vector<float> times;
+		FrameTimer ft( nFrames );
+		PerformanceOverlay overlay;
+		ResolutionGovernor governor( s.budget,RenderTarget::minRenderScale );
+		rt.SetRenderScale( s.scale );
+		double scaleSum = 0.0;
+		for( unsigned int frame = 0u; frame < nFrames; frame++ )
+		{
+			replay.AdvanceTo( float( frame ) * s.step,kbd,mouse );
+			PIPELINE_STAT( PipelineStatistics::ResetFrameTotals(); )
+			const auto start = std::chrono::steady_clock::now();
+			rt.BeginFrame();
+			pScene->Update( kbd,mouse,s.step );
+			pScene->Draw();
+			if( s.overlay )
+			{
+#ifdef PIPELINE_STATISTICS
+				overlay.Draw( rt,ft,&PipelineStatistics::FrameTotals() );
+#else
+				overlay.Draw( rt,ft );
+#endif
+			}
+			rt.EndFrame();
+			times.push_back( std::chrono::duration<float>( std::chrono::steady_clock::now() - start ).count() );
+			ft.Mark();
+			scaleSum += rt.GetRenderScale();
+			if( s.budget > 0.0f )
+			{
+				rt.SetRenderScale( governor.Update( times.back() ) );
+			}
+		}
+		if( times.empty() )
+		{
+			fprintf( stderr,"%s is empty\n",s.input.c_str() );
+			return 1;
+		}
+
+		double sum = 0.0;
+		for( float t : times )
+		{
+			sum += t;
+		}
+		std::vector<float> sorted = times;
+		std::sort( sorted.begin(),sorted.end() );
+		printf( "%s: %u recorded frames, %.2f s, %zu replayed frames at %.4f s, %ux%u\n",
+			pScene->GetName().c_str(),replay.GetFrameCount(),replay.GetDuration(),
+			times.size(),s.step,s.width,s.height );
+		if( s.budget > 0.0f || s.scale < 1.0f )
+		{
+			printf( "render scale %.3f mean, %.3f last\n",scaleSum / times.size(),rt.GetRenderScale() );
+		}
+		printf( "%10s %10s %10s %10s %10s %10s %10s\n","mean ms","p50","p90","p95","p99","worst","checksum" );
+		printf( "%10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.8x\n",
+			sum / times.size() * 1000.0,
+			Percentile( sorted,50.0f ) * 1000.0f,
+			Percentile( sorted,90.0f ) * 1000.0f,
+			Percentile( sorted,95.0f ) * 1000.0f,
+			Percentile( sorted,99.0f ) * 1000.0f,
+			sorted.back() * 1000.0f,
+			Checksum( rt.GetSurface() ) );
+		const FrameTimer::Statistics stats = ft.GetStatistics();
+		for( size_t p = 0; p < stats.passes.size(); p++ )
+		{
+			printf( "pass %zu: %.3f ms mean\n",p,stats.passes[p] * 1000.0f );
+		}
+		if( !s.save.empty() )
+		{
+			rt.Save( s.save );
+		}
+	}
+	catch( const ChiliException& e )
+	{
+		const std::wstring message = e.GetExceptionType() + L": " + e.GetFullMessage();
+		fprintf( stderr,"%ls\n",message.c_str() );
+		return 1;
+	}
+	return 0;
+}
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+
 #include "Vec3.h"
 #include "IndexedTriangleList.h"
+#include "Profiler.h"
 
 class AddObjFileModel
 {
@@ -9,7 +14,12 @@ public:
 	template<class V>
 	static IndexedTriangleList<V> GetSkinnedFromObjFile(float size, const std::wstring& filename)
 	{
+		PROFILE_ZONE( "load model" );
+#ifdef _WIN32
 		FILE * file = _wfopen(filename.c_str(), L"r");
+#else
+		FILE * file = fopen(std::string(filename.begin(), filename.end()).c_str(), "r");
+#endif
 		//gota add exception
 
 		std::vector<Vec3> vertices;
@@ -1,15 +1,27 @@
 #pragma once
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
 #include "Vec3.h"
 #include "IndexedTriangleList.h"
+#include "Profiler.h"
 
 class AddObjFileModelWithGS
 {
 public:
-	template<class V>
-	static IndexedTriangleListWithTC<V> GetSkinnedFromObjFileWithGS(float size, const std::wstring& filename)
+	// V gets the position, VTC the position and the texture coordinate
+	template<class V, class VTC>
+	static IndexedTriangleListWithTC<V, VTC> GetSkinnedFromObjFileWithGS(float size, const std::wstring& filename)
 	{
+		PROFILE_ZONE( "load model" );
+#ifdef _WIN32
 		FILE * file = _wfopen(filename.c_str(), L"r");
+#else
+		FILE * file = fopen(std::string(filename.begin(), filename.end()).c_str(), "r");
+#endif
 		//gota add exception
 
 		std::vector<V> vertices;
@@ -50,11 +62,40 @@ public:
 				triangles.push_back(vertexIndex[2] - 1);
 			}
 		}
+		// weld the two index streams
+		// a (position, texture coordinate) pair is a vertex, the pairs that are
+		// already in are found by a hash of their indices
+		std::unordered_map<unsigned long long, size_t> weldedOfPair;
+		std::vector<size_t> firstOfPosition(vertices.size(), size_t(-1));
+		std::vector<VTC> welded;
+		std::vector<size_t> firstAtPosition;
+		std::vector<size_t> weldedTriangles;
+		weldedOfPair.reserve(triangles.size());
+		weldedTriangles.reserve(triangles.size());
+		for (size_t i = 0; i < triangles.size(); i++)
+		{
+			const size_t position = triangles[i];
+			const unsigned long long pair = (unsigned long long)position << 32 | uvMapping[i];
+			const auto inserted = weldedOfPair.emplace(pair, welded.size());
+			if (inserted.second)
+			{
+				VTC vertex;
+				vertex.pos = vertices.at(position).pos;
+				vertex.t = tc.at(uvMapping[i]);
+				if (firstOfPosition[position] == size_t(-1))
+				{
+					firstOfPosition[position] = welded.size();
+				}
+				firstAtPosition.push_back(firstOfPosition[position]);
+				welded.push_back(vertex);
+			}
+			weldedTriangles.push_back(inserted.first->second);
+		}
+
 		return{
-			std::move(vertices),
-			std::move(triangles),
-			std::move(tc),
-			std::move(uvMapping)
+			{ std::move(vertices), std::move(triangles) },
+			{ std::move(welded), std::move(weldedTriangles) },
+			std::move(firstAtPosition)
 		};
 	}
 };
\ No newline at end of file
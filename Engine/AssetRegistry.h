@@ -0,0 +1,185 @@
+#pragma once
+
+#include "AddObjFileModel.h"
+#include "AddObjFileModelWithGS.h"
+#include "BackgroundTasks.h"
+#include "IndexedTriangleList.h"
+#include "Surface.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// meshes and textures shared by every scene
+// an asset is loaded the first time it is asked for, the later requests get
+// the same immutable copy for as long as someone still holds it. the registry
+// only keeps weak references: an asset nobody uses any more is freed, and
+// loaded again by the next request
+// textures are keyed by path, meshes by path, scale and vertex type
+//
+// Get* loads on the calling thread, Load* on the BackgroundTasks and returns
+// at once. both wait for / share a load of the same asset that is already
+// under way, so an asset is never loaded twice at the same time
+class AssetRegistry
+{
+public:
+	template<class T>
+	using Future = std::shared_future<std::shared_ptr<const T>>;
+public:
+	static std::shared_ptr<const Surface> GetTexture( const std::wstring& filename )
+	{
+		return Get<Surface>( filename,0.0f,TextureLoader( filename ),false ).get();
+	}
+	static Future<Surface> LoadTexture( const std::wstring& filename )
+	{
+		return Get<Surface>( filename,0.0f,TextureLoader( filename ),true );
+	}
+	// obj model with its texture coordinates in the vertices
+	template<class V>
+	static std::shared_ptr<const IndexedTriangleList<V>> GetMesh( const std::wstring& filename,float scale )
+	{
+		return Get<IndexedTriangleList<V>>( filename,scale,MeshLoader<V>( filename,scale ),false ).get();
+	}
+	template<class V>
+	static Future<IndexedTriangleList<V>> LoadMesh( const std::wstring& filename,float scale )
+	{
+		return Get<IndexedTriangleList<V>>( filename,scale,MeshLoader<V>( filename,scale ),true );
+	}
+	// obj model with the shared positions and their welded (position, texture coordinate) vertices
+	template<class V,class VTC>
+	static std::shared_ptr<const IndexedTriangleListWithTC<V,VTC>> GetMeshWithTC( const std::wstring& filename,float scale )
+	{
+		return Get<IndexedTriangleListWithTC<V,VTC>>( filename,scale,MeshWithTCLoader<V,VTC>( filename,scale ),false ).get();
+	}
+	template<class V,class VTC>
+	static Future<IndexedTriangleListWithTC<V,VTC>> LoadMeshWithTC( const std::wstring& filename,float scale )
+	{
+		return Get<IndexedTriangleListWithTC<V,VTC>>( filename,scale,MeshWithTCLoader<V,VTC>( filename,scale ),true );
+	}
+private:
+	typedef std::pair<std::wstring,float> Key;
+	// the loaders run later on another thread, they keep copies of the arguments
+	static std::function<Surface()> TextureLoader( std::wstring filename )
+	{
+		return [filename]() { return Surface::FromFile( filename ); };
+	}
+	template<class V>
+	static std::function<IndexedTriangleList<V>()> MeshLoader( std::wstring filename,float scale )
+	{
+		return [filename,scale]() { return AddObjFileModel::GetSkinnedFromObjFile<V>( scale,filename ); };
+	}
+	template<class V,class VTC>
+	static std::function<IndexedTriangleListWithTC<V,VTC>()> MeshWithTCLoader( std::wstring filename,float scale )
+	{
+		return [filename,scale]() { return AddObjFileModelWithGS::GetSkinnedFromObjFileWithGS<V,VTC>( scale,filename ); };
+	}
+	template<class T>
+	class Entry
+	{
+	public:
+		std::weak_ptr<const T> asset;
+		// valid while the asset is being loaded
+		Future<T> loading;
+	};
+	// the assets of one type
+	template<class T>
+	class Table
+	{
+	public:
+		std::mutex mutex;
+		std::map<Key,Entry<T>> assets;
+	};
+	// never destroyed, a background load can still finish while the program exits
+	template<class T>
+	static Table<T>& GetTable()
+	{
+		static Table<T>& table = *new Table<T>();
+		return table;
+	}
+	template<class T>
+	static Future<T> Get( const std::wstring& filename,float scale,std::function<T()> load,bool background )
+	{
+		Table<T>& table = GetTable<T>();
+		std::unique_lock<std::mutex> lock( table.mutex );
+		Entry<T>& entry = table.assets[Key( Normalize( filename ),scale )];
+		if( std::shared_ptr<const T> pAsset = entry.asset.lock() )
+		{
+			std::promise<std::shared_ptr<const T>> loaded;
+			loaded.set_value( std::move( pAsset ) );
+			return loaded.get_future().share();
+		}
+		if( entry.loading.valid() )
+		{
+			return entry.loading;
+		}
+		// map entries stay where they are, the task can keep a reference
+		std::packaged_task<std::shared_ptr<const T>()> task( [&table,&entry,load]()
+		{
+			try
+			{
+				std::shared_ptr<const T> pAsset = std::make_shared<const T>( load() );
+				std::lock_guard<std::mutex> lock( table.mutex );
+				entry.asset = pAsset;
+				entry.loading = Future<T>();
+				return pAsset;
+			}
+			catch( ... )
+			{
+				// the next request tries again
+				std::lock_guard<std::mutex> lock( table.mutex );
+				entry.loading = Future<T>();
+				throw;
+			}
+		} );
+		Future<T> loading = task.get_future().share();
+		entry.loading = loading;
+		lock.unlock();
+		if( background )
+		{
+			BackgroundTasks::Get().Submit( std::move( task ) );
+		}
+		else
+		{
+			task();
+		}
+		return loading;
+	}
+	// "images/a.jpg" and "images\a.jpg" are the same file
+	static std::wstring Normalize( std::wstring filename )
+	{
+		std::replace( filename.begin(),filename.end(),L'/',L'\\' );
+		return filename;
+	}
+};
+
+// the assets something is waiting for, holding them keeps them in the registry
+// until it is built from them
+class PendingAssets
+{
+public:
+	template<class T>
+	void Add( const AssetRegistry::Future<T>& asset )
+	{
+		assets.push_back( [asset]()
+		{
+			return asset.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+		} );
+	}
+	// every load has finished (or failed, the Get* of the asset throws again)
+	bool IsReady() const
+	{
+		return std::all_of( assets.begin(),assets.end(),[]( const std::function<bool()>& ready ) { return ready(); } );
+	}
+	void Clear()
+	{
+		assets.clear();
+	}
+private:
+	std::vector<std::function<bool()>> assets;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+// arithmetic of a vertex type, done on its interpolated attributes as one
+// packed run of floats
+// the vertex derives from AttributePack<Vertex,Attributes...> and declares
+// exactly those attributes (Vec3, Vec2, float, ...) as its first members in
+// the same order, members after them (like a flat Color) are not interpolated
+// and the results keep the ones of the left operand. the spare (zero) lane
+// of Vec3 is part of the run, it keeps the loops on whole sse registers
+//
+// every operation is one loop of a compile-time trip count over the floats,
+// which the compiler unrolls / vectorizes instead of building a temporary per
+// member. Lerp and AddScaled fuse the common a + (b - a) * t and a += b * s
+namespace AttributePackDetail
+{
+	constexpr size_t SumSizes()
+	{
+		return 0u;
+	}
+	template<class First,class... Rest>
+	constexpr size_t SumSizes( const First*,const Rest*... rest )
+	{
+		return sizeof( First ) + SumSizes( rest... );
+	}
+	template<class First,class... Rest>
+	constexpr size_t FirstSize( const First*,const Rest*... )
+	{
+		return sizeof( First );
+	}
+	// made of floats and without padding in front of any attribute
+	constexpr bool Packed( size_t )
+	{
+		return true;
+	}
+	template<class First,class... Rest>
+	constexpr bool Packed( size_t offset,const First*,const Rest*... rest )
+	{
+		return sizeof( First ) % sizeof( float ) == 0u && offset % alignof( First ) == 0u &&
+			Packed( offset + sizeof( First ),rest... );
+	}
+}
+
+template<class Vertex,class... Attributes>
+class AttributePack
+{
+public:
+	static constexpr size_t floatCount =
+		AttributePackDetail::SumSizes( static_cast<const Attributes*>( nullptr )... ) / sizeof( float );
+	// the first attribute is the position
+	static constexpr size_t positionFloatCount =
+		AttributePackDetail::FirstSize( static_cast<const Attributes*>( nullptr )... ) / sizeof( float );
+public:
+	Vertex& operator+=( const Vertex& rhs )
+	{
+		float* const a = Floats();
+		const float* const b = rhs.Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			a[i] += b[i];
+		}
+		return Self();
+	}
+	Vertex operator+( const Vertex& rhs ) const
+	{
+		return Vertex( Self() ) += rhs;
+	}
+	Vertex& operator-=( const Vertex& rhs )
+	{
+		float* const a = Floats();
+		const float* const b = rhs.Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			a[i] -= b[i];
+		}
+		return Self();
+	}
+	Vertex operator-( const Vertex& rhs ) const
+	{
+		return Vertex( Self() ) -= rhs;
+	}
+	Vertex& operator*=( float rhs )
+	{
+		float* const a = Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			a[i] *= rhs;
+		}
+		return Self();
+	}
+	Vertex operator*( float rhs ) const
+	{
+		return Vertex( Self() ) *= rhs;
+	}
+	Vertex& operator/=( float rhs )
+	{
+		float* const a = Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			a[i] /= rhs;
+		}
+		return Self();
+	}
+	Vertex operator/( float rhs ) const
+	{
+		return Vertex( Self() ) /= rhs;
+	}
+	// *this += rhs * s
+	Vertex& AddScaled( const Vertex& rhs,float s )
+	{
+		float* const a = Floats();
+		const float* const b = rhs.Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			a[i] += b[i] * s;
+		}
+		return Self();
+	}
+	// *this += rhs * s on the attributes after the position only, for stepping
+	// the attributes of a scanline (pixel shaders do not read the position)
+	Vertex& AddScaledAttributes( const Vertex& rhs,float s )
+	{
+		float* const a = Floats();
+		const float* const b = rhs.Floats();
+		for( size_t i = positionFloatCount; i < floatCount; i++ )
+		{
+			a[i] += b[i] * s;
+		}
+		return Self();
+	}
+	// a + (b - a) * t
+	static Vertex Lerp( const Vertex& a,const Vertex& b,float t )
+	{
+		Vertex out = a;
+		float* const o = out.Floats();
+		const float* const pa = a.Floats();
+		const float* const pb = b.Floats();
+		for( size_t i = 0; i < floatCount; i++ )
+		{
+			o[i] = pa[i] + (pb[i] - pa[i]) * t;
+		}
+		return out;
+	}
+	float* Floats()
+	{
+		CheckLayout();
+		return reinterpret_cast<float*>( static_cast<Vertex*>( this ) );
+	}
+	const float* Floats() const
+	{
+		CheckLayout();
+		return reinterpret_cast<const float*>( static_cast<const Vertex*>( this ) );
+	}
+private:
+	Vertex& Self()
+	{
+		return static_cast<Vertex&>( *this );
+	}
+	const Vertex& Self() const
+	{
+		return static_cast<const Vertex&>( *this );
+	}
+	// Vertex is only complete inside member functions
+	static void CheckLayout()
+	{
+		static_assert( std::is_standard_layout<Vertex>::value,"vertex attributes must be at the start of the vertex" );
+		static_assert( sizeof( Vertex ) >= floatCount * sizeof( float ),"vertex is smaller than its attributes" );
+		static_assert( AttributePackDetail::Packed( 0u,static_cast<const Attributes*>( nullptr )... ),"attributes must be floats without padding" );
+	}
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Profiler.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a few threads for the work that must not hold up a frame (asset loading)
+// tasks start in the order they were submitted, Submit returns the future of
+// the result (an exception of the task is thrown again by future::get)
+// unlike the WorkerPool of ParallelFor nobody waits for them in a frame, so
+// they keep running while the frames go on
+class BackgroundTasks
+{
+public:
+	static BackgroundTasks& Get()
+	{
+		static BackgroundTasks tasks;
+		return tasks;
+	}
+	BackgroundTasks( const BackgroundTasks& ) = delete;
+	BackgroundTasks& operator=( const BackgroundTasks& ) = delete;
+	// tasks still in the queue are dropped, their futures get a broken promise
+	~BackgroundTasks()
+	{
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			quit = true;
+		}
+		cv.notify_all();
+		for( auto& t : threads )
+		{
+			t.join();
+		}
+	}
+	template<class F>
+	auto Submit( F func ) -> std::future<decltype( func() )>
+	{
+		typedef decltype( func() ) Result;
+		// std::function needs a copyable target, the task itself is move only
+		auto pTask = std::make_shared<std::packaged_task<Result()>>( std::move( func ) );
+		std::future<Result> result = pTask->get_future();
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			queue.emplace_back( [pTask]() { (*pTask)(); } );
+		}
+		cv.notify_one();
+		return result;
+	}
+private:
+	BackgroundTasks()
+	{
+		// loading is mostly file reads and decoding, a couple of threads is enough
+		// and leaves the cores to the frames
+		const unsigned int nThreads = std::min( std::max( std::thread::hardware_concurrency() / 4u,1u ),2u );
+		for( unsigned int i = 0; i < nThreads; i++ )
+		{
+			threads.emplace_back( [this]() { WorkerLoop(); } );
+		}
+	}
+	void WorkerLoop()
+	{
+		PROFILE_THREAD_NAME( "loader" );
+		std::unique_lock<std::mutex> lock( mutex );
+		while( true )
+		{
+			cv.wait( lock,[this]() { return quit || !queue.empty(); } );
+			if( quit )
+			{
+				return;
+			}
+			std::function<void()> task = std::move( queue.front() );
+			queue.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::function<void()>> queue;
+	bool quit = false;
+};
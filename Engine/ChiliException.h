@@ -21,6 +21,11 @@
 #pragma once
 #include <string>
 
+#ifndef _CRT_WIDE
+#define _CRT_WIDE_( s ) L ## s
+#define _CRT_WIDE( s ) _CRT_WIDE_( s )
+#endif
+
 class ChiliException
 {
 public:
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// fast clear metadata for the frame buffers (color, w, stencil)
+// Clear() only bumps a frame generation. every span of spanWidth pixels of a
+// row keeps the generation it was last cleared in, and gets filled with the
+// clear value the first time it is touched after a Clear (or at present)
+//
+// spans never cross rows: the rasterizer hands every scanline to exactly one
+// thread, so two threads never fill the same span
+class ClearTags
+{
+public:
+	static constexpr int spanShift = 6;
+	static constexpr int spanWidth = 1 << spanShift;
+public:
+	ClearTags( int width,int height )
+		:
+		width( width ),
+		spansPerRow( (width + spanWidth - 1) >> spanShift ),
+		tags( size_t( (width + spanWidth - 1) >> spanShift ) * height,0u )
+	{}
+	// O(1), every span becomes stale
+	void Clear()
+	{
+		if( ++generation == 0u )
+		{
+			// wrapped around, old tags could match again
+			std::fill( tags.begin(),tags.end(),0u );
+			generation = 1u;
+		}
+	}
+	bool IsStale( int x,int y ) const
+	{
+		return tags[Index( x,y )] != generation;
+	}
+	// calls fill( xFirst,count ) for the span of (x,y) if it is stale
+	template<class Fill>
+	void Validate( int x,int y,Fill fill )
+	{
+		unsigned int& tag = tags[Index( x,y )];
+		if( tag != generation )
+		{
+			const int xFirst = x & ~(spanWidth - 1);
+			fill( xFirst,std::min( spanWidth,width - xFirst ) );
+			tag = generation;
+		}
+	}
+	// Validate for every span of row y that starts before xEnd
+	template<class Fill>
+	void ValidateRow( int y,Fill fill,int xEnd = std::numeric_limits<int>::max() )
+	{
+		for( int x = 0; x < std::min( width,xEnd ); x += spanWidth )
+		{
+			Validate( x,y,fill );
+		}
+	}
+private:
+	size_t Index( int x,int y ) const
+	{
+		return size_t( y ) * spansPerRow + (x >> spanShift);
+	}
+private:
+	int width;
+	int spansPerRow;
+	// tags start at 0, so a new buffer reads as cleared
+	unsigned int generation = 1u;
+	std::vector<unsigned int> tags;
+};
@@ -48,7 +48,7 @@ ExtVertex<T> ComputeIntersectionLEFT(const ExtVertex<T> eA, const ExtVertex<T> e
 
 	const float t = (-1.0f - eA.Vertex.pos.x) / (eB.Vertex.pos.x - eA.Vertex.pos.x);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.x = -1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -62,7 +62,7 @@ ExtVertex<T> ComputeIntersectionRIGHT(const ExtVertex<T> eA, const ExtVertex<T>
 
 	const float t = ( 1.0f - eA.Vertex.pos.x) / (eB.Vertex.pos.x - eA.Vertex.pos.x);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.x = 1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -76,7 +76,7 @@ ExtVertex<T> ComputeIntersectionBOTTOM(const ExtVertex<T> eA, const ExtVertex<T>
 
 	const float t = (-1.0f - eA.Vertex.pos.y) / (eB.Vertex.pos.y - eA.Vertex.pos.y);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.y = -1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -90,7 +90,7 @@ ExtVertex<T> ComputeIntersectionTOP(const ExtVertex<T> eA, const ExtVertex<T> eB
 
 	const float t = (1.0f - eA.Vertex.pos.y) / (eB.Vertex.pos.y - eA.Vertex.pos.y);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.y =  1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -104,7 +104,7 @@ ExtVertex<T> ComputeIntersectionNEAR(const ExtVertex<T> eA, const ExtVertex<T> e
 
 	const float t = (-1.0f - eA.Vertex.pos.z) / (eB.Vertex.pos.z - eA.Vertex.pos.z);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.z = -1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -118,7 +118,7 @@ ExtVertex<T> ComputeIntersectionFAR(const ExtVertex<T> eA, const ExtVertex<T> eB
 
 	const float t = ( 1.0f - eA.Vertex.pos.z) / (eB.Vertex.pos.z - eA.Vertex.pos.z);
  
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.z =  1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -134,7 +134,7 @@ ExtVertex<T> ComputeIntersectionPLANE(const ExtVertex<T> eA, const ExtVertex<T>
 
 	const float t = ( 1.0f - eA.Vertex.pos.z) / (eB.Vertex.pos.z - eA.Vertex.pos.z);
 
-	eOut.Vertex = eA.Vertex + (eB.Vertex - eA.Vertex) * t;
+	eOut.Vertex = T::Lerp(eA.Vertex, eB.Vertex, t);
 	eOut.Vertex.pos.z = -1.0f;
 
 	eOut.w = eA.w + t * (eB.w - eA.w);
@@ -51,7 +51,7 @@ public:
 	{}
 	explicit Color( const Vec3& cf )
 		:
-		Color( unsigned char( cf.x ),unsigned char( cf.y ),unsigned char( cf.z ) )
+		Color( (unsigned char)cf.x,(unsigned char)cf.y,(unsigned char)cf.z )
 	{}
 	explicit operator Vec3() const
 	{
@@ -62,11 +62,11 @@ public:
 		dword = color.dword;
 		return *this;
 	}
-	Color  operator *( unsigned __int8 alpha )
+	Color  operator *( unsigned char alpha )
 	{
-		unsigned __int8 r = ( ( (dword >> 16) & 0xFF) * alpha) >> 8;
-		unsigned __int8 g = ( ( (dword >> 8 ) & 0xFF) * alpha) >> 8;
-		unsigned __int8 b = ( ( (dword      ) & 0xFF) * alpha) >> 8;
+		unsigned char r = ( ( (dword >> 16) & 0xFF) * alpha) >> 8;
+		unsigned char g = ( ( (dword >> 8 ) & 0xFF) * alpha) >> 8;
+		unsigned char b = ( ( (dword      ) & 0xFF) * alpha) >> 8;
 		
 		return (r << 16) | (g << 8) | b;
 	}
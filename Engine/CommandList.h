@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include "Pipeline.h"
+#include "PipelineState.h"
+#include "Profiler.h"
+#include "FrameTimer.h"
+
+// recorded list of pipeline commands (frame begin, state, bindings and draws)
+// a list is owned by one thread while it is being recorded, so several
+// lists can be filled in parallel and then handed over to a CommandQueue
+class CommandList
+{
+	friend class CommandQueue;
+public:
+	// clear the z-buffer / stencil buffer of the pipeline
+	template<class Effect>
+	void BeginFrame(Pipeline<Effect>& pipeline, unsigned int pass = 0u)
+	{
+		Command cmd;
+		cmd.pass = pass;
+		cmd.pipeline = &pipeline;
+		cmd.hasState = false;
+		cmd.execute = [&pipeline]() { pipeline.BeginFrame(); };
+		commands.push_back(std::move(cmd));
+	}
+	// record a draw of triList with the given pipeline state
+	// bind is called with the effect of the pipeline right before the draw,
+	// so it should capture everything it needs (transforms, lights...) by value
+	// triList is referenced, it has to stay alive until the list is executed
+	template<class Effect, class Binder>
+	void Draw(Pipeline<Effect>& pipeline, const IndexedTriangleList<typename Effect::Vertex>& triList,
+		const PipelineState& state, Binder bind, unsigned int pass = 0u)
+	{
+		Command cmd;
+		cmd.pass = pass;
+		cmd.pipeline = &pipeline;
+		cmd.hasState = true;
+		cmd.state = state;
+		cmd.applyState = [&pipeline](const PipelineState& s) { pipeline.switchState(s); };
+		cmd.execute = [&pipeline, &triList, bind]() mutable
+		{
+			bind(pipeline.effect);
+			pipeline.Draw(triList);
+		};
+		commands.push_back(std::move(cmd));
+	}
+	size_t Size() const
+	{
+		return commands.size();
+	}
+	void Reset()
+	{
+		commands.clear();
+	}
+private:
+	class Command
+	{
+	public:
+		unsigned int pass;
+		const void* pipeline;
+		bool hasState;
+		PipelineState state;
+		std::function<void(const PipelineState&)> applyState;
+		std::function<void()> execute;
+	};
+private:
+	std::vector<Command> commands;
+};
+
+// collects the recorded lists of a frame and runs them on the calling thread
+// passes run in order, inside a pass the frame begins come first and then the
+// draws grouped by pipeline and state (groups in the order they first show up,
+// draws of a group in submission order), so every group switches state once
+// the draws of one pass must not depend on the order of the other groups of it
+// (stencil counts and equal z tests do not), draws that do get their own pass
+class CommandQueue
+{
+public:
+	// not thread safe, submit from the thread that calls Execute once the
+	// threads that recorded the lists are done (the order of the lists is part
+	// of the submission order)
+	void Submit(CommandList& list)
+	{
+		lists.push_back(&list);
+	}
+	void Execute()
+	{
+		// give every command the group of its pass, pipeline and state
+		order.clear();
+		groups.clear();
+		for (CommandList* pList : lists)
+		{
+			for (CommandList::Command& cmd : pList->commands)
+			{
+				Entry entry;
+				entry.pCmd = &cmd;
+				entry.group = FindGroup(cmd);
+				order.push_back(entry);
+			}
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[](const Entry& lhs, const Entry& rhs)
+			{
+				if (lhs.pCmd->pass != rhs.pCmd->pass)
+				{
+					return lhs.pCmd->pass < rhs.pCmd->pass;
+				}
+				if (lhs.pCmd->hasState != rhs.pCmd->hasState)
+				{
+					return !lhs.pCmd->hasState;
+				}
+				return lhs.group < rhs.group;
+			});
+
+		// skip switching state when the same pipeline runs with the same state again
+		const void* lastPipeline = nullptr;
+		PipelineState lastState;
+		// time of every pass goes to the frame statistics
+		auto passStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			CommandList::Command* pCmd = order[i].pCmd;
+			PROFILE_ZONE("pass", (int)pCmd->pass);
+			if (pCmd->hasState &&
+				(pCmd->pipeline != lastPipeline || pCmd->state != lastState))
+			{
+				pCmd->applyState(pCmd->state);
+				lastPipeline = pCmd->pipeline;
+				lastState = pCmd->state;
+			}
+			pCmd->execute();
+			if (i + 1 == order.size() || order[i + 1].pCmd->pass != pCmd->pass)
+			{
+				const auto passEnd = std::chrono::steady_clock::now();
+				FrameTimer::AddPassTime(pCmd->pass, std::chrono::duration<float>(passEnd - passStart).count());
+				passStart = passEnd;
+			}
+		}
+
+		for (CommandList* pList : lists)
+		{
+			pList->Reset();
+		}
+		lists.clear();
+	}
+private:
+	class Entry
+	{
+	public:
+		CommandList::Command* pCmd;
+		size_t group;
+	};
+	class Group
+	{
+	public:
+		unsigned int pass;
+		const void* pipeline;
+		bool hasState;
+		PipelineState state;
+	};
+private:
+	// a frame has a handful of groups, a linear search is enough
+	size_t FindGroup(const CommandList::Command& cmd)
+	{
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			const Group& g = groups[i];
+			if (g.pass == cmd.pass && g.pipeline == cmd.pipeline && g.hasState == cmd.hasState &&
+				(!cmd.hasState || g.state == cmd.state))
+			{
+				return i;
+			}
+		}
+		groups.push_back({ cmd.pass, cmd.pipeline, cmd.hasState, cmd.state });
+		return groups.size() - 1u;
+	}
+private:
+	std::vector<CommandList*> lists;
+	std::vector<Entry> order;
+	std::vector<Group> groups;
+};
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Scene.h"
-#include "AddObjFileModel.h"
+#include "AssetRegistry.h"
 #include "Mat3.h"
 #include "Pipeline.h"
 #include "TextureEffect.h"
@@ -10,19 +10,24 @@
 class CubeSkinFromObjScene : public Scene
 {
 public:
-	typedef Pipeline<TextureEffect> Pipeline;
+	typedef ::Pipeline<TextureEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	CubeSkinFromObjScene(Graphics& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename , const float scale)
+	CubeSkinFromObjScene(RenderTarget& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename , const float scale)
 		:
-		itlist(AddObjFileModel::GetSkinnedFromObjFile<Vertex>(scale, odjfilename)),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipeline(gfx, zb, sb),
+		pModel(AssetRegistry::GetMesh<Vertex>(odjfilename, scale)),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipeline(gfx, dsb),
 		Scene("Textured Cube skinned using texture: " + std::string(imagefilename.begin(), imagefilename.end()))
 	{
 		pipeline.effect.ps.BindTexture(imagefilename);
 	}
+	// the assets the constructor takes from the AssetRegistry
+	static void LoadAssets(PendingAssets& assets, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
+	{
+		assets.Add(AssetRegistry::LoadMesh<Vertex>(odjfilename, scale));
+		assets.Add(AssetRegistry::LoadTexture(imagefilename));
+	}
 	virtual void Update(Keyboard& kbd, Mouse& mouse, float dt) override
 	{
 		Vei2 mouseDelta = mouse.GetPos() - mouseLastPosition;
@@ -143,13 +148,12 @@ public:
 		pipeline.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
 		pipeline.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
 		// render triangles
-		pipeline.Draw(itlist);
+		pipeline.Draw(*pModel);
 	}
 private:
-	IndexedTriangleList<Vertex> itlist;
+	std::shared_ptr<const IndexedTriangleList<Vertex>> pModel;
 	Pipeline pipeline;
-	WBuffer zb;
-	StencilBuffer sb;
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
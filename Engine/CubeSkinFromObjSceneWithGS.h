@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Scene.h"
-#include "AddObjFileModelWithGS.h"
+#include "AssetRegistry.h"
 #include "Mat3.h"
 #include "Pipeline.h"
 #include "TextureEffectWithGS.h"
@@ -10,19 +10,24 @@
 class CubeSkinFromObjSceneWithGS : public Scene
 {
 public:
-	typedef Pipeline<TextureEffectWithGS> Pipeline;
+	typedef ::Pipeline<TextureEffectWithGS> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	CubeSkinFromObjSceneWithGS(Graphics& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
+	CubeSkinFromObjSceneWithGS(RenderTarget& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
 		:
-		itlistWithTextures(AddObjFileModelWithGS::GetSkinnedFromObjFileWithGS<Vertex>(scale, odjfilename)),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipeline(gfx, zb, sb),
+		pModel(AssetRegistry::GetMeshWithTC<DefaultVertex, Vertex>(odjfilename, scale)),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipeline(gfx, dsb),
 		Scene("Textured Cube skinned using texture: " + std::string(imagefilename.begin(), imagefilename.end()))
 	{
 		pipeline.effect.ps.BindTexture(imagefilename);
 	}
+	// the assets the constructor takes from the AssetRegistry
+	static void LoadAssets(PendingAssets& assets, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
+	{
+		assets.Add(AssetRegistry::LoadMeshWithTC<DefaultVertex, Vertex>(odjfilename, scale));
+		assets.Add(AssetRegistry::LoadTexture(imagefilename));
+	}
 	virtual void Update(Keyboard& kbd, Mouse& mouse, float dt) override
 	{
 		Vei2 mouseDelta = mouse.GetPos() - mouseLastPosition;
@@ -142,16 +147,13 @@ public:
 		pipeline.effect.vs.BindTranslation({ offset_x,offset_y,offset_z });
 		pipeline.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
 		pipeline.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
-		// set geometry shader
-		pipeline.effect.gs.BindShader(itlistWithTextures.tc, itlistWithTextures.uvMapping);
 		// render triangles
-		pipeline.Draw(itlistWithTextures.itlist);
+		pipeline.Draw(pModel->welded);
 	}
 private:
-	IndexedTriangleListWithTC<Vertex> itlistWithTextures;
+	std::shared_ptr<const IndexedTriangleListWithTC<DefaultVertex, Vertex>> pModel;
 	Pipeline pipeline;
-	WBuffer zb;
-	StencilBuffer sb;
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
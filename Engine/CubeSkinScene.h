@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Scene.h"
+#include "AssetRegistry.h"
 #include "Cube.h"
 #include "Mat3.h"
 #include "Pipeline.h"
@@ -10,19 +11,23 @@
 class CubeSkinScene : public Scene
 {
 public:
-	typedef Pipeline<TextureEffect> Pipeline;
+	typedef ::Pipeline<TextureEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	CubeSkinScene( Graphics& gfx,const std::wstring& filename )
+	CubeSkinScene( RenderTarget& gfx,const std::wstring& filename )
 		:
 		itlist( Cube::GetSkinned<Vertex>(1.0f) ),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipeline(gfx, zb, sb),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipeline(gfx, dsb),
 		Scene( "Textured Cube skinned using texture: " + std::string( filename.begin(),filename.end() ) )
 	{
 		pipeline.effect.ps.BindTexture( filename );
 	}
+	// the assets the constructor takes from the AssetRegistry
+	static void LoadAssets( PendingAssets& assets,const std::wstring& filename )
+	{
+		assets.Add( AssetRegistry::LoadTexture( filename ) );
+	}
 	virtual void Update( Keyboard& kbd,Mouse& mouse,float dt ) override
 	{
 		Vei2 mouseDelta = mouse.GetPos() - mouseLastPosition;
@@ -148,8 +153,7 @@ public:
 private:
 	IndexedTriangleList<Vertex> itlist;
 	Pipeline pipeline;
-	WBuffer zb;
-	StencilBuffer sb;
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
@@ -9,15 +9,14 @@
 class CubeSolidScene : public Scene
 {
 public:
-	typedef Pipeline<SolidEffect> Pipeline;
+	typedef ::Pipeline<SolidEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	CubeSolidScene( Graphics& gfx )
+	CubeSolidScene( RenderTarget& gfx )
 		:
 		itlist( Cube::GetPlainIndependentFaces<Vertex>() ),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipeline(gfx, zb, sb),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipeline(gfx, dsb),
 		Scene( "Colored cube vertex gradient scene" )
 	{
 		const Color colors[] = {
@@ -154,8 +153,7 @@ public:
 private:
 	IndexedTriangleList<Vertex> itlist;
 	Pipeline pipeline;
-	WBuffer zb;
-	StencilBuffer sb;
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
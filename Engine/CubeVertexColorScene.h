@@ -12,7 +12,7 @@ public:
 	typedef Pipeline<VertexColorEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	CubeVertexColorScene( Graphics& gfx )
+	CubeVertexColorScene( RenderTarget& gfx )
 		:
 		itlist( Cube::GetPlain<Vertex>() ),
 		pipeline( gfx ),
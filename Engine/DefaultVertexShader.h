@@ -1,6 +1,8 @@
 #pragma once
 
+#include "HardwareCounters.h"
 #include "IndexedTriangleList.h"
+#include "ParallelFor.h"
 
 template<class Vertex>
 class DefaultVertexShader
@@ -24,17 +26,22 @@ public:
 	{
 		camerarotation = camerarotation_in;
 	}
-	IndexedTriangleList<Output> operator()(std::vector<Vertex> vertices_in, std::vector<size_t> indices_in)
+	// every vertex is transformed on its own, so they get spread over the threads
+	// (each chunk counts under ProcessVertices on the thread that runs it)
+	IndexedTriangleList<Output> operator()(const std::vector<Vertex>& vertices_in, const std::vector<size_t>& indices_in) const
 	{
-	//	std::vector<Output> vertices_out;
-	//	vertices_out.reserve(vertices_in.size());
+		std::vector<Output> vertices_out(vertices_in);
+		ParallelForChunks(0, int(vertices_out.size()), [&](int begin, int end)
+		{
+			HW_COUNTER_STAGE( ProcessVertices );
+			for (int i = begin; i < end; i++)
+			{
+				Vertex& v = vertices_out[i];
+				v = { (v.pos * rotation + translation - position) * camerarotation, v };
+			}
+		});
 
-		std::transform(vertices_in.begin(), vertices_in.end(),
-		vertices_in.begin(),
-		[&](const auto& lambdain) -> Vertex {return { (lambdain.pos * rotation + translation - position) * camerarotation, lambdain }; });
-
-		IndexedTriangleList<Output> out(vertices_in, indices_in);
-		return out;
+		return IndexedTriangleList<Output>(std::move(vertices_out), indices_in);
 	}
 
 private:
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "WBuffer.h"
+#include "StencilBuffer.h"
+#include <algorithm>
+#include <cstdint>
+
+// depth and stencil of the render target as the pipeline sees them
+// stencil counts wrap around modulo 256 (like INCR_WRAP / DECR_WRAP), a pixel
+// inside a multiple of 256 volumes reads as outside, every other count is exact
+#ifndef PACKED_DEPTH_STENCIL
+// separate layout: float w buffer and a byte stencil buffer
+class DepthStencilBuffer : public WBuffer
+{
+public:
+	DepthStencilBuffer(int width, int height)
+		:
+		WBuffer(width, height),
+		sb(width, height)
+	{}
+	void Clear()
+	{
+		WBuffer::Clear();
+		sb.Clear();
+	}
+	bool StencilAt(int x, int y)
+	{
+		return sb.At(x, y);
+	}
+	void increaseStencilAt(int x, int y)
+	{
+		sb.increaseStencilAt(x, y);
+	}
+	void decreaseStencilAt(int x, int y)
+	{
+		sb.decreaseStencilAt(x, y);
+	}
+private:
+	StencilBuffer sb;
+};
+#else
+// packed layout: 24 bit fixed point depth over an 8 bit stencil in one word,
+// the depth test and the stencil ops of a pixel share one load / store
+//
+// the pipeline's depth is 1/z of view space, in [-1,0) behind the near plane
+// at z = -1. it is stored negated so that larger is nearer and the clear
+// value 0 is infinitely far, like the 0.0f of the float w buffer
+class DepthStencilBuffer
+{
+public:
+	static constexpr unsigned int stencilBits = 8u;
+	static constexpr std::uint32_t stencilMask = (1u << stencilBits) - 1u;
+	static constexpr std::uint32_t depthMask = ~stencilMask;
+	static constexpr std::uint32_t depthMax = depthMask >> stencilBits;
+public:
+	DepthStencilBuffer(int width, int height)
+		:
+		enableSet(true),
+		enableEqualTest(false),
+		width(width),
+		height(height),
+		pBuffer(new std::uint32_t[width*height]),
+		tags(width, height)
+	{}
+	~DepthStencilBuffer()
+	{
+		delete[] pBuffer;
+		pBuffer = nullptr;
+	}
+	DepthStencilBuffer(const DepthStencilBuffer&) = delete;
+	DepthStencilBuffer& operator=(const DepthStencilBuffer&) = delete;
+	// lazy, spans get their zeros the first time they are touched
+	void Clear()
+	{
+		tags.Clear();
+	}
+	bool TestAndSet(int x, int y, float depth)
+	{
+		std::uint32_t& word = At(x, y);
+		const std::uint32_t packed = Quantize(depth) << stencilBits;
+		const std::uint32_t depthInBuffer = word & depthMask;
+		if (packed > depthInBuffer || ((packed == depthInBuffer) && enableEqualTest))
+		{
+			if (enableSet == true)
+				word = packed | (word & stencilMask);
+			return true;
+		}
+		return false;
+	}
+	// the same test with the switches fixed at compile time
+	template<bool set, bool equalTest>
+	bool TestAndSet(int x, int y, float depth)
+	{
+		std::uint32_t& word = At(x, y);
+		const std::uint32_t packed = Quantize(depth) << stencilBits;
+		const std::uint32_t depthInBuffer = word & depthMask;
+		if (packed > depthInBuffer || (equalTest && packed == depthInBuffer))
+		{
+			if (set)
+				word = packed | (word & stencilMask);
+			return true;
+		}
+		return false;
+	}
+	bool StencilAt(int x, int y)
+	{
+		return !(At(x, y) & stencilMask);
+	}
+	void increaseStencilAt(int x, int y)
+	{
+		std::uint32_t& word = At(x, y);
+		word = (word & depthMask) | ((word + 1u) & stencilMask);
+	}
+	void decreaseStencilAt(int x, int y)
+	{
+		std::uint32_t& word = At(x, y);
+		word = (word & depthMask) | ((word - 1u) & stencilMask);
+	}
+
+public:
+	bool enableEqualTest;
+	bool enableSet;
+private:
+	static std::uint32_t Quantize(float depth)
+	{
+		const float nearness = std::min(std::max(-depth, 0.0f), 1.0f);
+		// signed conversion is a single instruction, and 1.0f * depthMax + 0.5f
+		// rounds up to 2^24 in float, hence the second clamp
+		return std::min(std::uint32_t(std::int32_t(nearness * float(depthMax) + 0.5f)), depthMax);
+	}
+	std::uint32_t& At(int x, int y)
+	{
+		std::uint32_t* const pLine = pBuffer + y * width;
+		tags.Validate(x, y, [pLine](int xFirst, int count)
+		{
+			std::fill(pLine + xFirst, pLine + xFirst + count, 0u);
+		});
+		return pLine[x];
+	}
+private:
+	int width;
+	int height;
+	std::uint32_t* pBuffer = nullptr;
+	ClearTags tags;
+};
+#endif
+
+class StencilBufferPtr 
+{
+public:
+	StencilBufferPtr(int x, int y, DepthStencilBuffer& dsb)
+		:
+		x(x),
+		y(y),
+		dsbRef(dsb)
+	{}
+	bool get()
+	{
+		return dsbRef.StencilAt(x, y);
+	}
+	void increase()
+	{
+		dsbRef.increaseStencilAt(x, y);
+	}
+	void decrease()
+	{
+		dsbRef.decreaseStencilAt(x, y);
+	}
+private:
+	int x;
+	int y;
+	DepthStencilBuffer& dsbRef;
+};
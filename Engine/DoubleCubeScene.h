@@ -13,7 +13,7 @@ public:
 	typedef Pipeline<SolidEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	DoubleCubeScene(Graphics& gfx)
+	DoubleCubeScene(RenderTarget& gfx)
 		:
 		itlist(Cube::GetPlainIndependentFaces<Vertex>()),
 		pipeline(gfx),
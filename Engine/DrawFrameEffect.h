@@ -2,49 +2,24 @@
 
 #include <cmath>
 #include "Pipeline.h"
+#include "AssetRegistry.h"
 #include "DefaultVertexShader.h"
+#include "DefaultGeometryShader.h"
 #include "VertexTypes.h"
 
 // basic texture effect
 class DrawFrameEffect
 {
 public:
-	typedef DefaultVertex Vertex;
-	typedef DefaultVertexWithTC VertexWithTC;
+	typedef DefaultVertexWithTC Vertex;
 
 public:
 	// default vs rotates and translates vertices
 	// does not touch attributes
 	typedef DefaultVertexShader<Vertex> VertexShader;
 
-	// custom gs gives every thriangles its texture coordinates
-
-	class GeometryShader
-	{
-	public:
-		void BindShader(const std::vector<Vec2>& tc_in, const std::vector<size_t>& uvMapping_in)
-		{
-			tc = tc_in;
-			uvMapping = uvMapping_in;
-		}
-
-	public:
-		typedef VertexWithTC Output;
-
-	public:
-		template<class Vertex>
-		Triangle<Output> operator()(const Vertex& in0, const Vertex& in1, const Vertex& in2, size_t triangle_index)
-		{
-			VertexWithTC out0(in0.pos, tc[uvMapping[triangle_index * 3]]);
-			VertexWithTC out1(in1.pos, tc[uvMapping[triangle_index * 3 + 1]]);
-			VertexWithTC out2(in2.pos, tc[uvMapping[triangle_index * 3 + 2]]);
-			return{ out0, out1, out2 };
-		}
-
-	private:
-		std::vector<Vec2> tc;
-		std::vector<size_t> uvMapping;
-	};
+	// the texture coordinates come with the vertices (welded at load time)
+	typedef DefaultGeometryShader<VertexShader::Output> GeometryShader;
 
 
 	// invoked for each pixel of a triangle
@@ -66,16 +41,25 @@ public:
 			else
 				return colorTex * 86;
 		}
+		// the texture of the file, shared with everything else that binds it
 		void BindTexture(const std::wstring& filename)
 		{
-			pTex = std::make_unique<Surface>(Surface::FromFile(filename));
+			BindTexture(AssetRegistry::GetTexture(filename));
+		}
+		void BindTexture(Surface tex)
+		{
+			BindTexture(std::make_shared<const Surface>(std::move(tex)));
+		}
+		void BindTexture(std::shared_ptr<const Surface> pTex_in)
+		{
+			pTex = std::move(pTex_in);
 			tex_width = float(pTex->GetWidth());
 			tex_height = float(pTex->GetHeight());
 			tex_xclamp = (pTex->GetWidth() - 1);
 			tex_yclamp = (pTex->GetHeight() - 1);
 		}
 	private:
-		std::unique_ptr<Surface> pTex;
+		std::shared_ptr<const Surface> pTex;
 		float tex_width;
 		float tex_height;
 		unsigned int tex_xclamp;
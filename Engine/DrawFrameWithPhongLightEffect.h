@@ -2,21 +2,22 @@
 
 #include <cmath>
 #include "Pipeline.h"
+#include "AssetRegistry.h"
+#include "DefaultGeometryShader.h"
 #include "VertexTypes.h"
 
 // basic texture effect
 class DrawFrameWithPhongLight
 {
 public:
-	typedef DefaultVertex Vertex;
-	typedef DefaultVertexWithPhong VertexWithPhong;
+	typedef DefaultVertexWithTC Vertex;
 	typedef DefaultVertexWithPhongAndTC VertexWithPhongAndTC;
 
 public:
 	class VertexShader
 	{
 	public:
-		typedef VertexWithPhong Output;
+		typedef VertexWithPhongAndTC Output;
 	public:
 		void BindRotation(const Mat3& rotation_in)
 		{
@@ -38,6 +39,13 @@ public:
 		{
 			lightsourceposition = lightsourceposition_in;
 		}
+		// the firstAtPosition of a welded model (IndexedTriangleListWithTC), kept by
+		// reference: the vertices a texture seam splits get one smooth normal
+		// unbound every vertex has a position of its own
+		void BindFirstAtPosition(const std::vector<size_t>& firstAtPosition_in)
+		{
+			pFirstAtPosition = &firstAtPosition_in;
+		}
 
 
 		IndexedTriangleList<Output> operator()(std::vector<Vertex> vertices_in, std::vector<size_t> indices_in)
@@ -48,32 +56,29 @@ public:
 
 			Vec3 lightsourceposition_use = (lightsourceposition - position) * camerarotation;
 
-			// Calculate average normal
-			Vec3* vertices_normals = new Vec3[vertices_in.size()];
-			for (size_t i = 0; i < vertices_in.size(); i++)
-			{
-				vertices_normals[i] = { 0.f, 0.f, 0.f };
-			}
+			// Calculate average normal (summed on the first vertex of every position)
+			const auto positionOf = [&](size_t i) { return pFirstAtPosition ? (*pFirstAtPosition)[i] : i; };
+			assert(!pFirstAtPosition || pFirstAtPosition->size() == vertices_in.size());
+			std::vector<Vec3> vertices_normals(vertices_in.size(), Vec3{ 0.f, 0.f, 0.f });
 			for (size_t i = 0; i < indices_in.size() / 3; i++)
 			{
 				Vec3 faceNormal = ((vertices_in[indices_in[i * 3 + 1]].pos - vertices_in[indices_in[i * 3]].pos) % (vertices_in[indices_in[i * 3 + 2]].pos - vertices_in[indices_in[i * 3]].pos)).GetNormalized();
-				vertices_normals[indices_in[i * 3]] += faceNormal;
-				vertices_normals[indices_in[i * 3 + 1]] += faceNormal;
-				vertices_normals[indices_in[i * 3 + 2]] += faceNormal;
+				vertices_normals[positionOf(indices_in[i * 3])] += faceNormal;
+				vertices_normals[positionOf(indices_in[i * 3 + 1])] += faceNormal;
+				vertices_normals[positionOf(indices_in[i * 3 + 2])] += faceNormal;
 			}
 
-			// Create the VertexWithPhong indexed triangle
-			std::vector<VertexWithPhong> vertices_out;
+			// Create the VertexWithPhongAndTC indexed triangle
+			std::vector<Output> vertices_out;
 			vertices_out.reserve(vertices_in.size());
 
 			for (size_t i = 0; i < vertices_in.size(); i++)
 			{
-				VertexWithPhong toPushBack(vertices_in[i].pos, lightsourceposition_use - vertices_in[i].pos, -vertices_in[i].pos, vertices_normals[i].GetNormalized());
+				Output toPushBack(vertices_in[i].pos, lightsourceposition_use - vertices_in[i].pos, -vertices_in[i].pos, vertices_normals[positionOf(i)].GetNormalized(), vertices_in[i].t);
 				vertices_out.push_back(toPushBack);
 			}
 
-			IndexedTriangleList<Output> out(vertices_out, indices_in);
-			return out;
+			return IndexedTriangleList<Output>(std::move(vertices_out), std::move(indices_in));
 		}
 
 	private:
@@ -83,36 +88,11 @@ public:
 		Vec3 position;
 
 		Vec3 lightsourceposition;
+		const std::vector<size_t>* pFirstAtPosition = nullptr;
 	};
 
-	// custom gs gives every thriangles its texture coordinates
-
-	class GeometryShader
-	{
-	public:
-		void BindShader(const std::vector<Vec2>& tc_in, const std::vector<size_t>& uvMapping_in)
-		{
-			tc = tc_in;
-			uvMapping = uvMapping_in;
-		}
-
-	public:
-		typedef VertexWithPhongAndTC Output;
-
-	public:
-		template<class Vertex>
-		Triangle<Output> operator()(const Vertex& in0, const Vertex& in1, const Vertex& in2, size_t triangle_index)
-		{
-			VertexWithPhongAndTC out0(in0.pos, in0.tolightsrc, in0.tocamera, in0.normal, tc[uvMapping[triangle_index * 3]]);
-			VertexWithPhongAndTC out1(in1.pos, in1.tolightsrc, in1.tocamera, in1.normal, tc[uvMapping[triangle_index * 3 + 1]]);
-			VertexWithPhongAndTC out2(in2.pos, in2.tolightsrc, in2.tocamera, in2.normal, tc[uvMapping[triangle_index * 3 + 2]]);
-			return{ out0, out1, out2 };
-		}
-
-	private:
-		std::vector<Vec2> tc;
-		std::vector<size_t> uvMapping;
-	};
+	// the texture coordinates come with the vertices (welded at load time)
+	typedef DefaultGeometryShader<VertexShader::Output> GeometryShader;
 
 
 	// invoked for each pixel of a triangle
@@ -147,9 +127,18 @@ public:
 			specularweight = specularweight_in;
 		}
 
+		// the texture of the file, shared with everything else that binds it
 		void BindTexture(const std::wstring& filename)
 		{
-			pTex = std::make_unique<Surface>(Surface::FromFile(filename));
+			BindTexture(AssetRegistry::GetTexture(filename));
+		}
+		void BindTexture(Surface tex)
+		{
+			BindTexture(std::make_shared<const Surface>(std::move(tex)));
+		}
+		void BindTexture(std::shared_ptr<const Surface> pTex_in)
+		{
+			pTex = std::move(pTex_in);
 			tex_width = float(pTex->GetWidth());
 			tex_height = float(pTex->GetHeight());
 			tex_xclamp = (pTex->GetWidth() - 1);
@@ -182,11 +171,11 @@ public:
 
 			light = std::min(light, 1.f);
 
-			return colorTex * (unsigned __int8)(255 * light);
+			return colorTex * (unsigned char)(255 * light);
 
 		}
 	private:
-		std::unique_ptr<Surface> pTex;
+		std::shared_ptr<const Surface> pTex;
 		float tex_width;
 		float tex_height;
 		unsigned int tex_xclamp;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <type_traits>
+
+// raster state an effect can fix at compile time
+// an effect declares a class Traits deriving from DefaultEffectTraits and
+// hides the members it fixes, the pipeline then compiles its raster loop for
+// just that state. Dynamic members keep following the switch* calls of the
+// pipeline (switchState / PipelineState), checked once per triangle and not
+// per pixel
+enum class DepthTest : unsigned char
+{
+	Dynamic,
+	Less,
+	// also passes pixels at the depth already in the buffer
+	LessEqual
+};
+
+enum class Toggle : unsigned char
+{
+	Dynamic,
+	Off,
+	On
+};
+
+enum class CullMode : unsigned char
+{
+	Dynamic,
+	// draws the triangles wound like the front faces
+	Back,
+	// draws the other ones (switchTurnFacing( true ))
+	Front
+};
+
+// what happens to the stencil of a pixel that passes the depth test
+enum class StencilOp : unsigned char
+{
+	// whatever the pixel shader does with its StencilBufferPtr
+	Shader,
+	Keep,
+	Increment,
+	Decrement
+};
+
+class DefaultEffectTraits
+{
+public:
+	static constexpr DepthTest depthTest = DepthTest::Dynamic;
+	static constexpr Toggle depthWrite = Toggle::Dynamic;
+	static constexpr Toggle colorWrite = Toggle::Dynamic;
+	static constexpr CullMode cullMode = CullMode::Dynamic;
+	static constexpr StencilOp stencilOp = StencilOp::Shader;
+	// false when the pixel shader ignores its input, the perspective divide is skipped
+	// and it gets the raw interpolants
+	static constexpr bool needsAttributes = true;
+};
+
+namespace EffectTraitsDetail
+{
+	template<class...>
+	class MakeVoid
+	{
+	public:
+		typedef void type;
+	};
+}
+
+// Effect::Traits if the effect has one, DefaultEffectTraits otherwise
+template<class Effect,class = void>
+class EffectTraits : public DefaultEffectTraits
+{};
+
+template<class Effect>
+class EffectTraits<Effect,typename EffectTraitsDetail::MakeVoid<typename Effect::Traits>::type> : public Effect::Traits
+{};
+
+template<class F>
+void SelectToggle( std::integral_constant<Toggle,Toggle::Dynamic>,bool runtime,const F& f )
+{
+	if( runtime )
+	{
+		f( std::true_type() );
+	}
+	else
+	{
+		f( std::false_type() );
+	}
+}
+
+template<class F>
+void SelectToggle( std::integral_constant<Toggle,Toggle::On>,bool,const F& f )
+{
+	f( std::true_type() );
+}
+
+template<class F>
+void SelectToggle( std::integral_constant<Toggle,Toggle::Off>,bool,const F& f )
+{
+	f( std::false_type() );
+}
+
+// calls f( std::true_type / std::false_type ) for the value of a toggle, the
+// runtime value only counts for Toggle::Dynamic
+template<Toggle toggle,class F>
+void SelectToggle( bool runtime,const F& f )
+{
+	SelectToggle( std::integral_constant<Toggle,toggle>(),runtime,f );
+}
+
+// LessEqual is the depth test with the equal test switched on
+constexpr Toggle EqualTestOf( DepthTest test )
+{
+	return test == DepthTest::Dynamic ? Toggle::Dynamic : test == DepthTest::LessEqual ? Toggle::On : Toggle::Off;
+}
@@ -14,8 +14,8 @@ public:
 		w = 1.0f;
 	}
 
-	template<class V>
-	ExtVertex(ExtVertex<V> extVertexIn)
+	template<class U>
+	ExtVertex(ExtVertex<U> extVertexIn)
 	{
 		Vertex = extVertexIn.Vertex;
 		w = extVertexIn.w;
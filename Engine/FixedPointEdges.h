@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Vec3.h"
+#include <algorithm>
+#include <cmath>
+
+// coverage of a screen space triangle from its three edge functions, on
+// vertices snapped to 24.8 fixed point (1/256 of a pixel)
+// the edge functions are exact integers, so the two triangles of a shared
+// edge compute the exact negation of each other, and the top-left rule gives
+// the pixel centers right on the edge to only one of them: every pixel of
+// a mesh without t-junctions is covered exactly once
+// (the float path can cover an edge pixel twice or not at all)
+class FixedPointEdges
+{
+public:
+	static constexpr int subpixelBits = 8;
+	static constexpr long long one = 1ll << subpixelBits;
+	static constexpr long long half = one / 2;
+public:
+	FixedPointEdges( const Vec3& p0,const Vec3& p1,const Vec3& p2 )
+	{
+		long long x[3] = { Snap( p0.x ),Snap( p1.x ),Snap( p2.x ) };
+		long long y[3] = { Snap( p0.y ),Snap( p1.y ),Snap( p2.y ) };
+		area2 = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		// the same winding for every triangle, inside is where all the edge functions are >= 0
+		if( area2 < 0 )
+		{
+			std::swap( x[1],x[2] );
+			std::swap( y[1],y[2] );
+			area2 = -area2;
+		}
+		for( int i = 0; i < 3; i++ )
+		{
+			const int j = (i + 1) % 3;
+			// e( px,py ) = a * px + b * py + c
+			const long long a = y[i] - y[j];
+			const long long b = x[j] - x[i];
+			const long long c = (y[j] - y[i]) * x[i] - (x[j] - x[i]) * y[i];
+			// pixel centers on a top or left edge are inside, on the others outside
+			const long long bias = (a > 0 || (a == 0 && b > 0)) ? 0 : 1;
+			// e( x * one + half,y * one + half ) - bias = a * one * x + k0 + k1 * y
+			const long long k0 = a * half + b * half + c - bias;
+			const long long k1 = b * one;
+			Bound& e = edges[i];
+			if( a > 0 )
+			{
+				// left edge, x >= ceil( -(k0 + k1 * y) / (a * one) )
+				e.side = Side::Left;
+				e.n0 = k0;
+				e.n1 = k1;
+				e.d = a * one;
+			}
+			else if( a < 0 )
+			{
+				// right edge, x <= floor( (k0 + k1 * y) / (-a * one) )
+				e.side = Side::Right;
+				e.n0 = k0;
+				e.n1 = k1;
+				e.d = -a * one;
+			}
+			else
+			{
+				// horizontal edge, the whole row is inside when k0 + k1 * y >= 0
+				e.side = Side::Horizontal;
+				e.n0 = k0;
+				e.n1 = k1;
+				e.d = 1;
+			}
+			e.dInv = 1.0 / double( e.d );
+		}
+		yMin = std::min( { y[0],y[1],y[2] } );
+		yMax = std::max( { y[0],y[1],y[2] } );
+	}
+	// no pixel center can be inside, after snapping
+	bool IsEmpty() const
+	{
+		return area2 == 0;
+	}
+	// first row with its center below the top vertex
+	int GetFirstRow() const
+	{
+		return int( CeilDiv( yMin - half,one ) );
+	}
+	// the row AFTER the last one that can have pixels
+	int GetEndRow() const
+	{
+		return int( FloorDiv( yMax - half,one ) ) + 1;
+	}
+	// the same rows from the unsnapped top / bottom y of a triangle
+	static int GetFirstRow( float yTop )
+	{
+		return int( CeilDiv( Snap( yTop ) - half,one ) );
+	}
+	static int GetEndRow( float yBottom )
+	{
+		return int( FloorDiv( Snap( yBottom ) - half,one ) ) + 1;
+	}
+	// pixels of row y inside the triangle, xEnd is the pixel AFTER the last one
+	// (clamped to [0,width), xEnd <= xStart when none are)
+	// the bound of every edge is linear in y, so a row costs one multiply-add
+	// and one division (by a reciprocal, corrected to the exact integer) per edge
+	void GetRow( int y,int width,int& xStart,int& xEnd ) const
+	{
+		long long lo = 0;
+		long long hi = width - 1;
+		for( const Bound& e : edges )
+		{
+			const long long n = e.n0 + e.n1 * y;
+			switch( e.side )
+			{
+			case Side::Left:
+				lo = std::max( lo,-FloorDiv( n,e ) );
+				break;
+			case Side::Right:
+				hi = std::min( hi,FloorDiv( n,e ) );
+				break;
+			case Side::Horizontal:
+				if( n < 0 )
+				{
+					hi = lo - 1;
+				}
+				break;
+			}
+		}
+		xStart = int( lo );
+		xEnd = int( std::max( hi + 1,lo ) );
+	}
+private:
+	enum class Side : unsigned char
+	{
+		Left,
+		Right,
+		Horizontal
+	};
+	// one edge function reduced to the pixel bound it puts on a row
+	class Bound
+	{
+	public:
+		Side side;
+		// numerator n0 + n1 * y over the denominator d > 0
+		long long n0;
+		long long n1;
+		long long d;
+		double dInv;
+	};
+private:
+	// round to nearest, one conversion instruction
+	static long long Snap( float v )
+	{
+		return std::lrint( v * float( one ) );
+	}
+	static long long FloorDiv( long long n,long long d )
+	{
+		const long long q = n / d;
+		return (n % d != 0 && (n < 0) != (d < 0)) ? q - 1 : q;
+	}
+	static long long CeilDiv( long long n,long long d )
+	{
+		return -FloorDiv( -n,d );
+	}
+	// floor( n / e.d ), the numerators stay far below 2^53 so the estimate
+	// is off by one at most
+	static long long FloorDiv( long long n,const Bound& e )
+	{
+		long long q = (long long)std::floor( double( n ) * e.dInv );
+		if( q * e.d > n )
+		{
+			q--;
+		}
+		else if( (q + 1) * e.d <= n )
+		{
+			q++;
+		}
+		return q;
+	}
+private:
+	Bound edges[3];
+	long long area2;
+	long long yMin;
+	long long yMax;
+};
@@ -1,8 +1,26 @@
 #include "FrameTimer.h"
+#include <algorithm>
 
 using namespace std::chrono;
 
-FrameTimer::FrameTimer()
+namespace
+{
+	// pass times reported since the last Mark (drawing thread only)
+	std::vector<float>& PendingPasses()
+	{
+		static std::vector<float> passes;
+		return passes;
+	}
+}
+
+constexpr float FrameTimer::binWidth;
+constexpr unsigned int FrameTimer::nBins;
+
+FrameTimer::FrameTimer( unsigned int window )
+	:
+	times( std::max( window,1u ) ),
+	passTimes( std::max( window,1u ) ),
+	histogram( nBins,0u )
 {
 	last = steady_clock::now();
 }
@@ -12,5 +30,81 @@ float FrameTimer::Mark()
 	const auto old = last;
 	last = steady_clock::now();
 	const duration<float> frameTime = last - old;
+
+	// the oldest frame leaves the window
+	if( count == times.size() )
+	{
+		histogram[Bin( times[next] )]--;
+	}
+	else
+	{
+		count++;
+	}
+	times[next] = frameTime.count();
+	histogram[Bin( frameTime.count() )]++;
+	passTimes[next].swap( PendingPasses() );
+	PendingPasses().clear();
+	next = (next + 1u) % (unsigned int)times.size();
+
 	return frameTime.count();
 }
+
+FrameTimer::Statistics FrameTimer::GetStatistics() const
+{
+	Statistics s;
+	s.frames = count;
+	if( count == 0u )
+	{
+		return s;
+	}
+	s.last = times[(next + (unsigned int)times.size() - 1u) % times.size()];
+	double sum = 0.0;
+	for( unsigned int i = 0u; i < count; i++ )
+	{
+		sum += times[i];
+		s.worst = std::max( s.worst,times[i] );
+		const std::vector<float>& passes = passTimes[i];
+		if( passes.size() > s.passes.size() )
+		{
+			s.passes.resize( passes.size(),0.0f );
+		}
+		for( size_t p = 0; p < passes.size(); p++ )
+		{
+			s.passes[p] += passes[p];
+		}
+	}
+	s.mean = float( sum / count );
+	for( float& p : s.passes )
+	{
+		p /= float( count );
+	}
+	std::vector<float> window( times.begin(),times.begin() + count );
+	s.p50 = Percentile( window,0.50f );
+	s.p95 = Percentile( window,0.95f );
+	s.p99 = Percentile( window,0.99f );
+	return s;
+}
+
+void FrameTimer::AddPassTime( unsigned int pass,float seconds )
+{
+	std::vector<float>& passes = PendingPasses();
+	if( pass >= passes.size() )
+	{
+		passes.resize( pass + 1u,0.0f );
+	}
+	passes[pass] += seconds;
+}
+
+unsigned int FrameTimer::Bin( float seconds )
+{
+	return std::min( (unsigned int)std::max( seconds / binWidth,0.0f ),nBins - 1u );
+}
+
+// the same ranks as the percentiles of SceneReplay, frames of any length
+float FrameTimer::Percentile( std::vector<float>& window,float p )
+{
+	const size_t rank = size_t( std::max( 1.0f,p * float( window.size() ) + 0.999f ) );
+	const auto nth = window.begin() + (std::min( rank,window.size() ) - 1u);
+	std::nth_element( window.begin(),nth,window.end() );
+	return *nth;
+}
@@ -1,11 +1,53 @@
 #pragma once
 #include <chrono>
+#include <vector>
 
+// frame timer that keeps the last frames for statistics
+// Mark() still returns the time since the previous Mark()
 class FrameTimer
 {
 public:
-	FrameTimer();
+	class Statistics
+	{
+	public:
+		// seconds
+		float last = 0.0f;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float worst = 0.0f;
+		// frames in the window
+		unsigned int frames = 0u;
+		// mean seconds of every command list pass over the window
+		std::vector<float> passes;
+	};
+public:
+	FrameTimer( unsigned int window = 240u );
 	float Mark();
+	Statistics GetStatistics() const;
+	// frames of the window per bin of binWidth seconds, the last bin collects the slower ones
+	// (for display, the percentiles of the statistics come from the exact times)
+	const std::vector<unsigned int>& GetHistogram() const
+	{
+		return histogram;
+	}
+	// command queues report the time of every pass they run here,
+	// the next Mark() (of any timer) moves them into that timer's window
+	static void AddPassTime( unsigned int pass,float seconds );
+public:
+	static constexpr float binWidth = 0.00025f;
+	static constexpr unsigned int nBins = 200u;
+private:
+	static unsigned int Bin( float seconds );
+	// nearest rank, reorders window
+	static float Percentile( std::vector<float>& window,float p );
 private:
 	std::chrono::steady_clock::time_point last;
-};
\ No newline at end of file
+	// rolling window of frame times and pass times (ring buffers)
+	std::vector<float> times;
+	std::vector<std::vector<float>> passTimes;
+	unsigned int next = 0u;
+	unsigned int count = 0u;
+	std::vector<unsigned int> histogram;
+};
@@ -26,6 +26,8 @@
 #include "CubeSkinFromObjScene.h"
 #include "CubeSkinFromObjSceneWithGS.h"
 #include "CubeSolidScene.h"
+#include "Profiler.h"
+#include <chrono>
 #include <sstream>
 
 Game::Game( MainWindow& wnd )
@@ -33,23 +35,33 @@ Game::Game( MainWindow& wnd )
 	wnd( wnd ),
 	gfx( wnd )
 {
-	scenes.push_back(std::make_unique<ShadowVolumesWithLightingScene>(gfx, L"Objects\\q3rocket.obj", L"images\\rocketl.jpg", 0.25f));
-	scenes.push_back(std::make_unique<ShadowVolumesScene>(gfx, L"Objects\\q3rocket.obj", L"images\\rocketl.jpg", 0.25f));
-//	scenes.push_back(std::make_unique<CubeSkinFromObjScene>(gfx, L"Objects\\q3rocket.obj", L"images\\rocketl.jpg" , 0.25f));
-	scenes.push_back(std::make_unique<CubeSkinFromObjSceneWithGS>(gfx, L"Objects\\q3rocket.obj", L"images\\rocketl.jpg", 0.25f));
-	scenes.push_back(std::make_unique<CubeSkinScene>(gfx, L"images\\office_skin.jpg"));
-	scenes.push_back(std::make_unique<CubeSolidScene>(gfx));
+	// the assets of every scene start loading in the background right away, a
+	// scene gets built when it is first shown and its assets are in
+	const std::wstring rocket = L"Objects\\q3rocket.obj";
+	const std::wstring rocketTexture = L"images\\rocketl.jpg";
+	scenes.push_back(LazyScene::Make<ShadowVolumesWithLightingScene>(gfx, rocket, rocketTexture, 0.25f));
+	scenes.push_back(LazyScene::Make<ShadowVolumesScene>(gfx, rocket, rocketTexture, 0.25f));
+//	scenes.push_back(LazyScene::Make<CubeSkinFromObjScene>(gfx, rocket, rocketTexture, 0.25f));
+	scenes.push_back(LazyScene::Make<CubeSkinFromObjSceneWithGS>(gfx, rocket, rocketTexture, 0.25f));
+	scenes.push_back(LazyScene::Make<CubeSkinScene>(gfx, std::wstring(L"images\\office_skin.jpg")));
+	scenes.push_back(LazyScene::Make<CubeSolidScene>(gfx));
 
 	curScene = scenes.begin();
-	OutputSceneName();
+	PROFILE_THREAD_NAME( "main" );
 }
 
 void Game::Go()
 {
+	PROFILE_FRAME();
+	PIPELINE_STAT( PipelineStatistics::ResetFrameTotals(); )
 	gfx.BeginFrame();
 	UpdateModel();
+	const auto composeStart = std::chrono::steady_clock::now();
 	ComposeFrame();
+	const std::chrono::duration<float> composeTime = std::chrono::steady_clock::now() - composeStart;
 	gfx.EndFrame();
+	// the present waits for vsync, only the rendering counts against the budget
+	gfx.SetRenderScale( dynamicResolution ? governor.Update( composeTime.count() ) : 1.0f );
 }
 
 void Game::UpdateModel()
@@ -74,9 +86,56 @@ void Game::UpdateModel()
 		{
 			wnd.Kill();
 		}
+		// frame time / pipeline counter overlay
+		else if( e.GetCode() == VK_F1 && e.IsPress() )
+		{
+			showOverlay = !showOverlay;
+		}
+		// dynamic resolution on / off
+		else if( e.GetCode() == VK_F2 && e.IsPress() )
+		{
+			dynamicResolution = !dynamicResolution;
+			governor.Reset();
+		}
+		// start / stop recording the input for replays (SceneReplay)
+		else if( e.GetCode() == VK_F8 && e.IsPress() )
+		{
+			if( recording )
+			{
+				recorder.Save( "input.rec" );
+			}
+			recorder.Clear();
+			recording = !recording;
+		}
+#ifdef PROFILER
+		// dump the last 60 frames for chrome://tracing
+		else if( e.GetCode() == VK_F9 && e.IsPress() )
+		{
+			const unsigned int frame = Profiler::GetFrame();
+			Profiler::WriteChromeTrace( "trace.json",frame > 60u ? frame - 60u : 0u,frame - 1u );
+		}
+#endif
+	}
+	if( recording )
+	{
+		recorder.Capture( wnd.kbd,wnd.mouse,dt );
+	}
+	// switch to the current scene once it is built, until then the one
+	// before it (or none, right after the start) stays on screen
+	if( Scene* pScene = (*curScene)->Get() )
+	{
+		if( pScene != pShownScene )
+		{
+			pShownScene = pScene;
+			OutputSceneName();
+		}
 	}
 	// update scene
-	(*curScene)->Update( wnd.kbd,wnd.mouse,dt );
+	PROFILE_ZONE( "update" );
+	if( pShownScene )
+	{
+		pShownScene->Update( wnd.kbd,wnd.mouse,dt );
+	}
 }
 
 void Game::CycleScenes()
@@ -85,7 +144,6 @@ void Game::CycleScenes()
 	{
 		curScene = scenes.begin();
 	}
-	OutputSceneName();
 }
 
 void Game::ReverseCycleScenes()
@@ -98,16 +156,15 @@ void Game::ReverseCycleScenes()
 	{
 		--curScene;
 	}
-	OutputSceneName();
 }
 
 void Game::OutputSceneName() const
 {
 	std::stringstream ss;
-	const std::string stars( (*curScene)->GetName().size() + 4,'*' );
+	const std::string stars( pShownScene->GetName().size() + 4,'*' );
 
 	ss << stars << std::endl 
-		<< "* " << (*curScene)->GetName() << " *" << std::endl 
+		<< "* " << pShownScene->GetName() << " *" << std::endl 
 		<< stars << std::endl;
 	OutputDebugStringA( ss.str().c_str() );
 }
@@ -115,5 +172,17 @@ void Game::OutputSceneName() const
 void Game::ComposeFrame()
 {
 	// draw scene
-	(*curScene)->Draw();
+	PROFILE_ZONE( "compose" );
+	if( pShownScene )
+	{
+		pShownScene->Draw();
+	}
+	if( showOverlay )
+	{
+#ifdef PIPELINE_STATISTICS
+		overlay.Draw( gfx,ft,&PipelineStatistics::FrameTotals() );
+#else
+		overlay.Draw( gfx,ft );
+#endif
+	}
 }
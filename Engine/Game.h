@@ -24,7 +24,11 @@
 #include <memory>
 #include <vector>
 #include "Scene.h"
+#include "LazyScene.h"
 #include "FrameTimer.h"
+#include "InputRecording.h"
+#include "PerformanceOverlay.h"
+#include "ResolutionGovernor.h"
 
 class Game
 {
@@ -48,7 +52,15 @@ private:
 	/********************************/
 	/*  User Variables              */
 	FrameTimer ft;
-	std::vector<std::unique_ptr<Scene>> scenes;
-	std::vector<std::unique_ptr<Scene>>::iterator curScene;
+	InputRecorder recorder;
+	bool recording = false;
+	PerformanceOverlay overlay;
+	bool showOverlay = false;
+	ResolutionGovernor governor;
+	bool dynamicResolution = false;
+	std::vector<std::unique_ptr<LazyScene>> scenes;
+	std::vector<std::unique_ptr<LazyScene>>::iterator curScene;
+	// the scene on screen, curScene while it is built
+	Scene* pShownScene = nullptr;
 	/********************************/
 };
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "Graphics.h"
 #include "DXErr.h"
 #include "ChiliException.h"
+#include "Profiler.h"
 #include <assert.h>
 #include <string>
 #include <array>
@@ -41,7 +42,7 @@ using Microsoft::WRL::ComPtr;
 
 Graphics::Graphics( HWNDKey& key )
 	:
-	sysBuffer( ScreenWidth,ScreenHeight )
+	RenderTarget( ScreenWidth,ScreenHeight )
 {
 	assert( key.hWnd != nullptr );
 
@@ -248,6 +249,7 @@ Graphics::~Graphics()
 
 void Graphics::EndFrame()
 {
+	PROFILE_ZONE( "present" );
 	HRESULT hr;
 
 	// lock and map the adapter memory for copying over the sysbuffer
@@ -257,7 +259,7 @@ void Graphics::EndFrame()
 		throw CHILI_GFX_EXCEPTION( hr,L"Mapping sysbuffer" );
 	}
 	// perform the copy line-by-line
-	sysBuffer.Present( mappedSysBufferTexture.RowPitch,
+	Present( mappedSysBufferTexture.RowPitch,
 		reinterpret_cast<BYTE*>(mappedSysBufferTexture.pData) );
 	// release the adapter memory
 	pImmediateContext->Unmap( pSysBufferTexture.Get(),0u );
@@ -283,7 +285,7 @@ void Graphics::EndFrame()
 
 void Graphics::BeginFrame()
 {
-	sysBuffer.Clear( Colors::Red );
+	Clear( Colors::Black );
 }
 
 
@@ -24,12 +24,13 @@
 #include "GDIPlusManager.h"
 #include "ChiliException.h"
 #include "Surface.h"
+#include "RenderTarget.h"
 #include "Colors.h"
 #include "Vec2.h"
 
 #define CHILI_GFX_EXCEPTION( hr,note ) Graphics::Exception( hr,note,_CRT_WIDE(__FILE__),__LINE__ )
 
-class Graphics
+class Graphics : public RenderTarget
 {
 public:
 	class Exception : public ChiliException
@@ -54,21 +55,13 @@ public:
 	Graphics( class HWNDKey& key );
 	Graphics( const Graphics& ) = delete;
 	Graphics& operator=( const Graphics& ) = delete;
-	void EndFrame();
-	void BeginFrame();
+	virtual void EndFrame() override;
+	virtual void BeginFrame() override;
 	void DrawLine( const Vec2& p1,const Vec2& p2,Color c )
 	{
 		DrawLine( p1.x,p1.y,p2.x,p2.y,c );
 	}
 	void DrawLine( float x1,float y1,float x2,float y2,Color c );
-	void PutPixel( int x,int y,int r,int g,int b )
-	{
-		PutPixel( x,y,{ unsigned char( r ),unsigned char( g ),unsigned char( b ) } );
-	}
-	void PutPixel( int x,int y,Color c )
-	{
-		sysBuffer.PutPixel( x,y,c );
-	}
 	~Graphics();
 private:
 	GDIPlusManager										gdipMan;
@@ -84,7 +77,6 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11InputLayout>			pInputLayout;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState>			pSamplerState;
 	D3D11_MAPPED_SUBRESOURCE							mappedSysBufferTexture;
-	Surface												sysBuffer;
 public:
 	static constexpr unsigned int ScreenWidth = 1366u;
 	static constexpr unsigned int ScreenHeight = 768u;
@@ -0,0 +1,184 @@
+#include "HardwareCounters.h"
+
+#ifdef HW_COUNTERS_ENABLED
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	// counters of one thread, opened as one group so a single read() gets all of them
+	class ThreadCounters
+	{
+	public:
+		ThreadCounters()
+		{
+			static const std::uint64_t configs[HardwareCounters::nEvents][2] = {
+				{ PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES },
+				{ PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS },
+				{ PERF_TYPE_HW_CACHE,PERF_COUNT_HW_CACHE_L1D |
+					(PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+				{ PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES },
+				{ PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES },
+			};
+			for (int e = 0; e < HardwareCounters::nEvents; e++)
+			{
+				perf_event_attr attr;
+				memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = (std::uint32_t)configs[e][0];
+				attr.config = configs[e][1];
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+				// the first event that opens leads the group
+				attr.disabled = leader < 0 ? 1 : 0;
+				const int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+				if (fd < 0)
+				{
+					continue;
+				}
+				if (leader < 0)
+				{
+					leader = fd;
+				}
+				fds[e] = fd;
+				ioctl(fd, PERF_EVENT_IOC_ID, &ids[e]);
+			}
+			if (leader >= 0)
+			{
+				ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+				last = Read();
+			}
+		}
+		~ThreadCounters()
+		{
+			for (int fd : fds)
+			{
+				if (fd >= 0)
+				{
+					close(fd);
+				}
+			}
+		}
+		// moves the counts since the last transition to the running stage
+		void Transition()
+		{
+			if (leader < 0)
+			{
+				return;
+			}
+			const HardwareCounters::Values now = Read();
+			if (!stack.empty())
+			{
+				HardwareCounters::Values& stage = stages[stack.back()];
+				for (int e = 0; e < HardwareCounters::nEvents; e++)
+				{
+					stage.counts[e] += now.counts[e] - last.counts[e];
+				}
+			}
+			last = now;
+		}
+	public:
+		int leader = -1;
+		int fds[HardwareCounters::nEvents] = { -1,-1,-1,-1,-1 };
+		std::uint64_t ids[HardwareCounters::nEvents] = {};
+		std::vector<HardwareCounters::Stage> stack;
+		HardwareCounters::Values last;
+		HardwareCounters::Values stages[HardwareCounters::nStages];
+	private:
+		HardwareCounters::Values Read() const
+		{
+			// { nr, { value, id } * nr }
+			std::uint64_t data[1 + 2 * HardwareCounters::nEvents] = {};
+			HardwareCounters::Values v;
+			if (read(leader, data, sizeof(data)) <= 0)
+			{
+				return last;
+			}
+			for (std::uint64_t i = 0; i < data[0]; i++)
+			{
+				for (int e = 0; e < HardwareCounters::nEvents; e++)
+				{
+					if (fds[e] >= 0 && ids[e] == data[2 + 2 * i])
+					{
+						v.counts[e] = (long long)data[1 + 2 * i];
+					}
+				}
+			}
+			return v;
+		}
+	};
+
+	// threads keep pointers to their counters, they stay alive until the end of the program
+	std::mutex& ThreadsMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+	std::vector<std::unique_ptr<ThreadCounters>>& Threads()
+	{
+		static std::vector<std::unique_ptr<ThreadCounters>> threads;
+		return threads;
+	}
+	ThreadCounters& Local()
+	{
+		static thread_local ThreadCounters* pCounters = []()
+		{
+			std::lock_guard<std::mutex> lock(ThreadsMutex());
+			Threads().push_back(std::make_unique<ThreadCounters>());
+			return Threads().back().get();
+		}();
+		return *pCounters;
+	}
+}
+
+bool HardwareCounters::IsAvailable(Event e)
+{
+	return Local().fds[e] >= 0;
+}
+
+// the counts only need to be read when the running stage changes
+void HardwareCounters::Begin(Stage stage)
+{
+	ThreadCounters& t = Local();
+	if (t.stack.empty() || t.stack.back() != stage)
+	{
+		t.Transition();
+	}
+	t.stack.push_back(stage);
+}
+
+void HardwareCounters::End()
+{
+	ThreadCounters& t = Local();
+	const size_t depth = t.stack.size();
+	if (depth < 2 || t.stack[depth - 2] != t.stack[depth - 1])
+	{
+		t.Transition();
+	}
+	t.stack.pop_back();
+}
+
+HardwareCounters::Report HardwareCounters::Collect()
+{
+	std::lock_guard<std::mutex> lock(ThreadsMutex());
+	Report report;
+	for (auto& pThread : Threads())
+	{
+		for (int s = 0; s < nStages; s++)
+		{
+			report.stages[s] += pThread->stages[s];
+			pThread->stages[s] = Values();
+		}
+	}
+	return report;
+}
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+// hardware performance counters per pipeline stage (linux perf_event_open)
+// define HARDWARE_COUNTERS to enable them, on other platforms or without the
+// define the HW_COUNTER_* macros expand to nothing
+//
+// counts are exclusive: when a stage starts inside another one, the outer
+// stage is paused, so ProcessTriangle does not include the rasterizer time
+// only user space is counted, the read() calls themselves don't show up
+//
+// every change of the running stage reads the counters (a read() syscall),
+// so stages are opened once per triangle or per chunk of rows / vertices,
+// never per scanline or pixel. opening the stage that is already running
+// costs nothing
+#if defined( HARDWARE_COUNTERS ) && defined( __linux__ )
+#define HW_COUNTERS_ENABLED
+#endif
+
+class HardwareCounters
+{
+public:
+	enum Stage
+	{
+		// vertex shader of a draw
+		ProcessVertices,
+		// triangle assembly, geometry shader, near plane / frustum clipping
+		ProcessTriangle,
+		// sorting, gradients and edges of a triangle
+		TriangleSetup,
+		// the rows of a triangle: row extents, w test, stencil, pixel shader and write
+		Scanlines,
+		nStages
+	};
+	enum Event
+	{
+		Cycles,
+		Instructions,
+		L1DMisses,
+		LLCMisses,
+		BranchMisses,
+		nEvents
+	};
+	class Values
+	{
+	public:
+		Values& operator+=(const Values& rhs)
+		{
+			for (int e = 0; e < nEvents; e++)
+			{
+				counts[e] += rhs.counts[e];
+			}
+			return *this;
+		}
+		double Ratio(Event num, Event den) const
+		{
+			return counts[den] > 0 ? double(counts[num]) / double(counts[den]) : 0.0;
+		}
+	public:
+		long long counts[nEvents] = {};
+	};
+	class Report
+	{
+	public:
+		Values Total() const
+		{
+			Values total;
+			for (const Values& v : stages)
+			{
+				total += v;
+			}
+			return total;
+		}
+	public:
+		Values stages[nStages];
+	};
+public:
+#ifdef HW_COUNTERS_ENABLED
+	// true if the event could be opened on the calling thread
+	// (virtual machines and perf_event_paranoid > 2 usually give nothing)
+	static bool IsAvailable(Event e);
+	static void Begin(Stage stage);
+	static void End();
+	// sum of all threads since the last Collect, resets the counts
+	// call it between frames, while no stage is running
+	static Report Collect();
+#else
+	static bool IsAvailable(Event)
+	{
+		return false;
+	}
+	static Report Collect()
+	{
+		return Report();
+	}
+#endif
+	static const char* GetStageName(Stage stage)
+	{
+		static const char* const names[nStages] = {
+			"ProcessVertices","ProcessTriangle","TriangleSetup","Scanlines"
+		};
+		return names[stage];
+	}
+};
+
+#ifdef HW_COUNTERS_ENABLED
+class HardwareCounterScope
+{
+public:
+	HardwareCounterScope(HardwareCounters::Stage stage)
+	{
+		HardwareCounters::Begin(stage);
+	}
+	HardwareCounterScope(const HardwareCounterScope&) = delete;
+	HardwareCounterScope& operator=(const HardwareCounterScope&) = delete;
+	~HardwareCounterScope()
+	{
+		HardwareCounters::End();
+	}
+};
+
+#define HW_COUNTER_CONCAT_IMPL( a,b ) a##b
+#define HW_COUNTER_CONCAT( a,b ) HW_COUNTER_CONCAT_IMPL( a,b )
+// attribute the counts until the end of the enclosing scope to stage
+#define HW_COUNTER_STAGE( stage ) HardwareCounterScope HW_COUNTER_CONCAT( hwCounterScope,__LINE__ )( HardwareCounters::stage )
+#else
+#define HW_COUNTER_STAGE( stage )
+#endif
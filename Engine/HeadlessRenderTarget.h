@@ -0,0 +1,34 @@
+#pragma once
+
+#include "RenderTarget.h"
+
+// offscreen render target backed by a plain surface
+// no window or device needed, the frame stays in memory after EndFrame
+class HeadlessRenderTarget : public RenderTarget
+{
+public:
+	HeadlessRenderTarget( unsigned int width,unsigned int height,Color clearColor = Colors::Black )
+		:
+		RenderTarget( width,height ),
+		clearColor( clearColor )
+	{}
+	virtual void BeginFrame() override
+	{
+		Clear( clearColor );
+	}
+	virtual void EndFrame() override
+	{
+		frameCount++;
+	}
+	unsigned int GetFrameCount() const
+	{
+		return frameCount;
+	}
+	void Save( const std::wstring& filename ) const
+	{
+		GetSurface().Save( filename );
+	}
+private:
+	Color clearColor;
+	unsigned int frameCount = 0u;
+};
@@ -19,20 +19,29 @@ public:
 	std::vector<size_t> indices;
 };
 
-template<class T>
+// an obj model, where positions and texture coordinates have index streams of
+// their own, welded at load time (AddObjFileModelWithGS): every (position,
+// texture coordinate) pair the faces use becomes one vertex of welded, so the
+// effects find the texture coordinates in their vertices
+template<class T,class TC>
 class IndexedTriangleListWithTC
 {
 public:
-	IndexedTriangleListWithTC( std::vector<T> verts_in, std::vector<size_t> indices_in, std::vector<Vec2> tc_in, std::vector<size_t> uvMapping_in )
+	IndexedTriangleListWithTC( IndexedTriangleList<T> itlist_in,IndexedTriangleList<TC> welded_in,std::vector<size_t> firstAtPosition_in )
 		:
-		itlist( verts_in, indices_in ),
-		tc( std::move(tc_in) ),
-		uvMapping( std::move(uvMapping_in) )
+		itlist( std::move( itlist_in ) ),
+		welded( std::move( welded_in ) ),
+		firstAtPosition( std::move( firstAtPosition_in ) )
 	{
-		assert(tc.size() > 2);
-		assert(uvMapping.size() % 3 == 0);
+		assert( itlist.indices.size() == welded.indices.size() );
+		assert( firstAtPosition.size() == welded.vertices.size() );
 	}
+	// the triangles over the positions alone, neighbours share their vertices
+	// (the shadow volumes find the silhouette edges through them)
 	IndexedTriangleList<T> itlist;
-	std::vector<Vec2> tc;
-	std::vector<size_t> uvMapping;
+	// the same triangles in the same order over the welded vertices
+	IndexedTriangleList<TC> welded;
+	// for every vertex of welded the first one with the same position, the
+	// vertices a texture seam splits share their normal through it
+	std::vector<size_t> firstAtPosition;
 };
\ No newline at end of file
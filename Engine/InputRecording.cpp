@@ -0,0 +1,235 @@
+#include "InputRecording.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+	enum EventType : unsigned char
+	{
+		KeyPress,
+		KeyRelease,
+		MouseMove,
+		LeftPress,
+		LeftRelease,
+		RightPress,
+		RightRelease
+	};
+
+	const char magic[4] = { 'I','R','E','C' };
+	const std::uint32_t version = 1u;
+
+	void PutU16( std::vector<unsigned char>& out,std::uint16_t v )
+	{
+		out.push_back( (unsigned char)(v & 0xFFu) );
+		out.push_back( (unsigned char)(v >> 8) );
+	}
+	void PutU32( std::vector<unsigned char>& out,std::uint32_t v )
+	{
+		PutU16( out,(std::uint16_t)(v & 0xFFFFu) );
+		PutU16( out,(std::uint16_t)(v >> 16) );
+	}
+	std::uint32_t GetU32( const unsigned char* p )
+	{
+		return std::uint32_t( p[0] ) | (std::uint32_t( p[1] ) << 8) |
+			(std::uint32_t( p[2] ) << 16) | (std::uint32_t( p[3] ) << 24);
+	}
+	std::uint16_t GetU16( const unsigned char* p )
+	{
+		return std::uint16_t( p[0] | (p[1] << 8) );
+	}
+}
+
+void InputRecorder::Capture( const Keyboard& kbd,const Mouse& mouse,float dt )
+{
+	std::uint32_t bits;
+	memcpy( &bits,&dt,sizeof( bits ) );
+	PutU32( frames,bits );
+	// event count is patched in after the events
+	const size_t countAt = frames.size();
+	PutU16( frames,0u );
+	std::uint16_t count = 0u;
+
+	for( unsigned int k = 0u; k < 256u; k++ )
+	{
+		const bool pressed = kbd.KeyIsPressed( (unsigned char)k );
+		if( pressed != lastKeys[k] )
+		{
+			frames.push_back( pressed ? KeyPress : KeyRelease );
+			frames.push_back( (unsigned char)k );
+			lastKeys[k] = pressed;
+			count++;
+		}
+	}
+	// the first frame always stores the position
+	if( frameCount == 0u || mouse.GetPosX() != lastX || mouse.GetPosY() != lastY )
+	{
+		frames.push_back( MouseMove );
+		PutU16( frames,(std::uint16_t)(std::int16_t)mouse.GetPosX() );
+		PutU16( frames,(std::uint16_t)(std::int16_t)mouse.GetPosY() );
+		lastX = mouse.GetPosX();
+		lastY = mouse.GetPosY();
+		count++;
+	}
+	if( mouse.LeftIsPressed() != lastLeft )
+	{
+		lastLeft = mouse.LeftIsPressed();
+		frames.push_back( lastLeft ? LeftPress : LeftRelease );
+		count++;
+	}
+	if( mouse.RightIsPressed() != lastRight )
+	{
+		lastRight = mouse.RightIsPressed();
+		frames.push_back( lastRight ? RightPress : RightRelease );
+		count++;
+	}
+	frames[countAt] = (unsigned char)(count & 0xFFu);
+	frames[countAt + 1] = (unsigned char)(count >> 8);
+	frameCount++;
+}
+
+bool InputRecorder::Save( const std::string& filename ) const
+{
+	std::vector<unsigned char> header( magic,magic + 4 );
+	PutU32( header,version );
+	PutU32( header,frameCount );
+
+	FILE* pFile = fopen( filename.c_str(),"wb" );
+	if( pFile == nullptr )
+	{
+		return false;
+	}
+	const bool written = fwrite( header.data(),1u,header.size(),pFile ) == header.size() &&
+		fwrite( frames.data(),1u,frames.size(),pFile ) == frames.size();
+	return fclose( pFile ) == 0 && written;
+}
+
+void InputRecorder::Clear()
+{
+	frames.clear();
+	frameCount = 0u;
+	lastKeys.reset();
+	lastX = 0;
+	lastY = 0;
+	lastLeft = false;
+	lastRight = false;
+}
+
+InputReplay::InputReplay( const std::string& filename )
+{
+	auto fail = [&filename]( const wchar_t* reason )
+	{
+		std::wstringstream ss;
+		ss << L"Loading input recording [" << std::wstring( filename.begin(),filename.end() ) << L"]: " << reason;
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+	};
+
+	FILE* pFile = fopen( filename.c_str(),"rb" );
+	if( pFile == nullptr )
+	{
+		fail( L"failed to open." );
+	}
+	std::vector<unsigned char> data;
+	{
+		unsigned char chunk[4096];
+		size_t nRead;
+		while( (nRead = fread( chunk,1u,sizeof( chunk ),pFile )) > 0u )
+		{
+			data.insert( data.end(),chunk,chunk + nRead );
+		}
+		fclose( pFile );
+	}
+
+	if( data.size() < 12u || memcmp( data.data(),magic,4u ) != 0 )
+	{
+		fail( L"not an input recording." );
+	}
+	if( GetU32( &data[4] ) != version )
+	{
+		fail( L"unsupported version." );
+	}
+	frameCount = GetU32( &data[8] );
+
+	size_t pos = 12u;
+	auto need = [&]( size_t n )
+	{
+		if( pos + n > data.size() )
+		{
+			fail( L"file is truncated." );
+		}
+	};
+	// events of a frame happened before the update of that frame, so they
+	// get the time the frame started at
+	double time = 0.0;
+	for( unsigned int f = 0u; f < frameCount; f++ )
+	{
+		need( 6u );
+		const std::uint32_t bits = GetU32( &data[pos] );
+		float dt;
+		memcpy( &dt,&bits,sizeof( dt ) );
+		const unsigned int count = GetU16( &data[pos + 4] );
+		pos += 6u;
+		for( unsigned int i = 0u; i < count; i++ )
+		{
+			need( 1u );
+			Event e = { float( time ),data[pos++],0u,0,0 };
+			switch( e.type )
+			{
+			case KeyPress:
+			case KeyRelease:
+				need( 1u );
+				e.code = data[pos++];
+				break;
+			case MouseMove:
+				need( 4u );
+				e.x = (std::int16_t)GetU16( &data[pos] );
+				e.y = (std::int16_t)GetU16( &data[pos + 2] );
+				pos += 4u;
+				break;
+			case LeftPress:
+			case LeftRelease:
+			case RightPress:
+			case RightRelease:
+				break;
+			default:
+				fail( L"unknown event." );
+			}
+			events.push_back( e );
+		}
+		time += dt;
+	}
+	duration = float( time );
+}
+
+void InputReplay::AdvanceTo( float time,Keyboard& kbd,Mouse& mouse )
+{
+	for( ; next < events.size() && events[next].time <= time; next++ )
+	{
+		const Event& e = events[next];
+		switch( e.type )
+		{
+		case KeyPress:
+			kbd.OnKeyPressed( e.code );
+			break;
+		case KeyRelease:
+			kbd.OnKeyReleased( e.code );
+			break;
+		case MouseMove:
+			mouse.OnMouseMove( e.x,e.y );
+			break;
+		case LeftPress:
+			mouse.OnLeftPressed( mouse.GetPosX(),mouse.GetPosY() );
+			break;
+		case LeftRelease:
+			mouse.OnLeftReleased( mouse.GetPosX(),mouse.GetPosY() );
+			break;
+		case RightPress:
+			mouse.OnRightPressed( mouse.GetPosX(),mouse.GetPosY() );
+			break;
+		case RightRelease:
+			mouse.OnRightReleased( mouse.GetPosX(),mouse.GetPosY() );
+			break;
+		}
+	}
+}
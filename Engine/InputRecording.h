@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Keyboard.h"
+#include "Mouse.h"
+#include "ChiliException.h"
+#include <bitset>
+#include <string>
+#include <vector>
+
+// keyboard / mouse recording for repeatable scene benchmarks
+//
+// the recorder compares the input state once per frame with the previous
+// frame and stores the changes (key press / release, mouse move / buttons)
+// together with the dt of the frame. the replay turns them back into events
+// with a timestamp, so the same path can be fed to Scene::Update at any
+// fixed timestep.
+//
+// file: "IREC", version, frame count, then per frame
+//   dt (float), event count (u16), events (type u8 + code u8 or x,y as i16)
+// every value is little endian
+
+class InputRecorder
+{
+public:
+	// call once per frame, before the scene reads the input
+	void Capture( const Keyboard& kbd,const Mouse& mouse,float dt );
+	bool Save( const std::string& filename ) const;
+	void Clear();
+	unsigned int GetFrameCount() const
+	{
+		return frameCount;
+	}
+private:
+	std::vector<unsigned char> frames;
+	unsigned int frameCount = 0u;
+	std::bitset<256> lastKeys;
+	int lastX = 0;
+	int lastY = 0;
+	bool lastLeft = false;
+	bool lastRight = false;
+};
+
+class InputReplay
+{
+public:
+	class Exception : public ChiliException
+	{
+	public:
+		using ChiliException::ChiliException;
+		virtual std::wstring GetFullMessage() const override { return GetNote() + L"\nAt: " + GetLocation(); }
+		virtual std::wstring GetExceptionType() const override { return L"Input Replay Exception"; }
+	};
+public:
+	InputReplay( const std::string& filename );
+	// feeds every event recorded up to time (seconds since the start) into kbd and mouse
+	void AdvanceTo( float time,Keyboard& kbd,Mouse& mouse );
+	// length of the recording in seconds
+	float GetDuration() const
+	{
+		return duration;
+	}
+	unsigned int GetFrameCount() const
+	{
+		return frameCount;
+	}
+	void Rewind()
+	{
+		next = 0u;
+	}
+private:
+	class Event
+	{
+	public:
+		float time;
+		unsigned char type;
+		unsigned char code;
+		int x;
+		int y;
+	};
+private:
+	std::vector<Event> events;
+	size_t next = 0u;
+	float duration = 0.0f;
+	unsigned int frameCount = 0u;
+};
@@ -22,9 +22,26 @@
 #include <queue>
 #include <bitset>
 
+#ifndef _WIN32
+// virtual key codes the scenes use (values of winuser.h)
+// windows builds get them from ChiliWin.h
+#define VK_TAB 0x09
+#define VK_SHIFT 0x10
+#define VK_ESCAPE 0x1B
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+#define VK_F1 0x70
+#define VK_F2 0x71
+#define VK_F8 0x77
+#define VK_F9 0x78
+#endif
+
 class Keyboard
 {
 	friend class MainWindow;
+	friend class InputReplay;
 public:
 	class Event
 	{
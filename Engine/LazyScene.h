@@ -0,0 +1,45 @@
+#pragma once
+
+#include "AssetRegistry.h"
+#include "RenderTarget.h"
+#include "Scene.h"
+#include <functional>
+#include <memory>
+
+// a scene that gets built the first time it is asked for, once the assets it
+// started loading in the background when it was made are in (its constructor
+// then finds them in the AssetRegistry instead of loading them)
+class LazyScene
+{
+public:
+	// S::LoadAssets( assets,args... ) starts the loads, S( gfx,args... ) builds the scene
+	template<class S,class... Args>
+	static std::unique_ptr<LazyScene> Make( RenderTarget& gfx,Args... args )
+	{
+		std::unique_ptr<LazyScene> pLazy( new LazyScene() );
+		S::LoadAssets( pLazy->assets,args... );
+		pLazy->make = [&gfx,args...]() -> std::unique_ptr<Scene>
+		{
+			return std::make_unique<S>( gfx,args... );
+		};
+		return pLazy;
+	}
+	// the scene, nullptr while its assets are still loading
+	Scene* Get()
+	{
+		if( !pScene && assets.IsReady() )
+		{
+			pScene = make();
+			// the scene holds on to what it took from the registry now
+			assets.Clear();
+			make = nullptr;
+		}
+		return pScene.get();
+	}
+private:
+	LazyScene() = default;
+private:
+	PendingAssets assets;
+	std::function<std::unique_ptr<Scene>()> make;
+	std::unique_ptr<Scene> pScene;
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "Profiler.h"
+#include <algorithm>
+
+// parallel loop used by the pipeline
+// msvc builds keep using the concurrency runtime (ppl), other
+// builds fall back to a small pool of persistent worker threads
+#ifdef _MSC_VER
+#include "ppl.h"
+#include "concrt.h"
+#else
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+	static WorkerPool& Get()
+	{
+		static WorkerPool pool;
+		return pool;
+	}
+	WorkerPool( const WorkerPool& ) = delete;
+	WorkerPool& operator=( const WorkerPool& ) = delete;
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			quit = true;
+		}
+		wakeCv.notify_all();
+		for( auto& t : threads )
+		{
+			t.join();
+		}
+	}
+	// worker threads plus the calling thread (at most the limit)
+	unsigned int GetThreadCount() const
+	{
+		const unsigned int all = (unsigned int)threads.size() + 1u;
+		const unsigned int limit = threadLimit.load();
+		return limit != 0u ? std::min( limit,all ) : all;
+	}
+	// spread the Run calls that start after this over at most n threads, 0 for all
+	// of them (the spare workers stay asleep)
+	void SetThreadLimit( unsigned int n )
+	{
+		threadLimit = n;
+	}
+	// calls func(i) for every i in [first,last), split in one static chunk per thread
+	// nested calls (from inside a worker) and calls from a second thread while the
+	// pool is busy run serially on the calling thread
+	template<class F>
+	void Run( int first,int last,const F& func )
+	{
+		const int count = last - first;
+		if( count <= 0 )
+		{
+			return;
+		}
+		const auto runSerial = [&]()
+		{
+			for( int i = first; i < last; i++ )
+			{
+				func( i );
+			}
+		};
+		if( count == 1 || GetThreadCount() == 1u || IsWorkerThread() || IsInsideRun() )
+		{
+			runSerial();
+			return;
+		}
+		// the thread that holds submitMutex never gets here (IsInsideRun), so try_lock
+		// only tells the calls of other threads that the pool is busy
+		std::unique_lock<std::mutex> submit( submitMutex,std::try_to_lock );
+		if( !submit.owns_lock() )
+		{
+			runSerial();
+			return;
+		}
+		IsInsideRun() = true;
+		const int nChunks = std::min( count,int( GetThreadCount() ) );
+		const std::function<void( int )> chunk = [&]( int c )
+		{
+			const int begin = first + int( (long long)count * c / nChunks );
+			const int end = first + int( (long long)count * (c + 1) / nChunks );
+			for( int i = begin; i < end; i++ )
+			{
+				func( i );
+			}
+		};
+		unsigned long long job;
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			pChunk = &chunk;
+			chunkCount = nChunks;
+			job = ++generation;
+			nextChunk.store( (job & 0xFFFFFFFFull) << 32u );
+		}
+		if( nChunks - 1 < int( threads.size() ) )
+		{
+			// no point in waking the workers that can not get a chunk
+			for( int i = 0; i < nChunks - 1; i++ )
+			{
+				wakeCv.notify_one();
+			}
+		}
+		else
+		{
+			wakeCv.notify_all();
+		}
+		Work( job,chunk,nChunks );
+		// wait for the workers that are still running a chunk
+		std::unique_lock<std::mutex> lock( mutex );
+		doneCv.wait( lock,[this]() { return activeWorkers == 0; } );
+		pChunk = nullptr;
+		IsInsideRun() = false;
+	}
+private:
+	WorkerPool()
+	{
+		const unsigned int nThreads = std::max( std::thread::hardware_concurrency(),1u );
+		for( unsigned int i = 1; i < nThreads; i++ )
+		{
+			threads.emplace_back( [this]() { WorkerLoop(); } );
+		}
+	}
+	static bool& IsWorkerThread()
+	{
+		static thread_local bool isWorker = false;
+		return isWorker;
+	}
+	// set while the thread runs a job of its own, nested calls then run serially
+	// instead of locking submitMutex a second time
+	static bool& IsInsideRun()
+	{
+		static thread_local bool isInside = false;
+		return isInside;
+	}
+	// runs chunks of the given job only, chunk and nChunks are the ones that were
+	// read with the job under the mutex (chunk is only touched after a chunk of
+	// that job was claimed, so its Run has not returned yet)
+	void Work( unsigned long long job,const std::function<void( int )>& chunk,int nChunks )
+	{
+		const unsigned long long tag = (job & 0xFFFFFFFFull) << 32u;
+		unsigned long long next = nextChunk.load();
+		while( (next & ~0xFFFFFFFFull) == tag && int( next & 0xFFFFFFFFull ) < nChunks )
+		{
+			if( nextChunk.compare_exchange_weak( next,next + 1u ) )
+			{
+				const int c = int( next & 0xFFFFFFFFull );
+				// gaps between chunks on the worker rows of a trace are idle time
+				PROFILE_ZONE( "parallel chunk",c );
+				chunk( c );
+				next = nextChunk.load();
+			}
+		}
+	}
+	void WorkerLoop()
+	{
+		IsWorkerThread() = true;
+		PROFILE_THREAD_NAME( "worker" );
+		unsigned long long seen = 0u;
+		std::unique_lock<std::mutex> lock( mutex );
+		while( true )
+		{
+			wakeCv.wait( lock,[&]() { return quit || generation != seen; } );
+			if( quit )
+			{
+				return;
+			}
+			seen = generation;
+			if( pChunk == nullptr )
+			{
+				// the job is already over, its Run took every chunk itself
+				continue;
+			}
+			const std::function<void( int )>& chunk = *pChunk;
+			const int nChunks = chunkCount;
+			activeWorkers++;
+			lock.unlock();
+			Work( seen,chunk,nChunks );
+			lock.lock();
+			if( --activeWorkers == 0 )
+			{
+				doneCv.notify_all();
+			}
+		}
+	}
+private:
+	std::vector<std::thread> threads;
+	std::mutex submitMutex;
+	std::mutex mutex;
+	std::condition_variable wakeCv;
+	std::condition_variable doneCv;
+	const std::function<void( int )>* pChunk = nullptr;
+	int chunkCount = 0;
+	// generation of the job in the high 32 bits, its next chunk in the low ones, so
+	// a worker that woke up late for an older job can never claim (or run a second
+	// time) a chunk of the current one
+	std::atomic<unsigned long long> nextChunk{ 0u };
+	unsigned long long generation = 0u;
+	int activeWorkers = 0;
+	bool quit = false;
+	std::atomic<unsigned int> threadLimit{ 0u };
+};
+#endif
+
+#ifdef _MSC_VER
+namespace ParallelForDetail
+{
+	// 0 for all the processors
+	inline unsigned int& ThreadLimit()
+	{
+		static unsigned int limit = 0u;
+		return limit;
+	}
+}
+#endif
+
+// threads a ParallelFor spreads over, the calling one included
+inline unsigned int ParallelThreadCount()
+{
+#ifdef _MSC_VER
+	const unsigned int all = Concurrency::GetProcessorCount();
+	const unsigned int limit = ParallelForDetail::ThreadLimit();
+	return limit != 0u ? std::min( limit,all ) : all;
+#else
+	return WorkerPool::Get().GetThreadCount();
+#endif
+}
+
+// ParallelFor calls that start after this use at most n threads, 0 for all of them
+// (set from PipelineTuning, not meant to change while a ParallelFor runs)
+inline void SetParallelThreadLimit( unsigned int n )
+{
+#ifdef _MSC_VER
+	ParallelForDetail::ThreadLimit() = n;
+#else
+	WorkerPool::Get().SetThreadLimit( n );
+#endif
+}
+
+template<class F>
+inline void ParallelFor( int first,int last,const F& func )
+{
+#ifdef _MSC_VER
+	const int nThreads = int( ParallelThreadCount() );
+	if( nThreads < int( Concurrency::GetProcessorCount() ) && last - first > nThreads )
+	{
+		// one static chunk per allowed thread, the runtime can not run more of them
+		// at once than there are chunks
+		const int count = last - first;
+		Concurrency::parallel_for( 0,nThreads,[&]( int c )
+		{
+			const int end = first + int( (long long)count * (c + 1) / nThreads );
+			for( int i = first + int( (long long)count * c / nThreads ); i < end; i++ )
+			{
+				func( i );
+			}
+		},Concurrency::static_partitioner() );
+		return;
+	}
+	Concurrency::parallel_for( first,last,func,Concurrency::static_partitioner() );
+#else
+	WorkerPool::Get().Run( first,last,func );
+#endif
+}
+
+// calls func(begin,end) once per thread for its static chunk of [first,last), the
+// same chunks as a ParallelFor over the range, for work that has a per chunk
+// setup (hardware counter stages, thread local buffers)
+template<class F>
+inline void ParallelForChunks( int first,int last,const F& func )
+{
+	const int count = last - first;
+	if( count <= 0 )
+	{
+		return;
+	}
+	const int nChunks = std::min( count,int( ParallelThreadCount() ) );
+	ParallelFor( 0,nChunks,[&]( int c )
+	{
+		func( first + int( (long long)count * c / nChunks ),first + int( (long long)count * (c + 1) / nChunks ) );
+	});
+}
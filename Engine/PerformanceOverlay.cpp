@@ -0,0 +1,260 @@
+#include "PerformanceOverlay.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// ascii 32 ('space') to 95 ('_'), one byte per row, bit 4 is the left column
+	const unsigned char font[64][7] = {
+	{ 0x00,0x00,0x00,0x00,0x00,0x00,0x00 },	// space
+	{ 0x04,0x04,0x04,0x04,0x04,0x00,0x04 },	// !
+	{ 0x0A,0x0A,0x0A,0x00,0x00,0x00,0x00 },	// "
+	{ 0x0A,0x0A,0x1F,0x0A,0x1F,0x0A,0x0A },	// #
+	{ 0x04,0x0F,0x14,0x0E,0x05,0x1E,0x04 },	// $
+	{ 0x18,0x19,0x02,0x04,0x08,0x13,0x03 },	// %
+	{ 0x0C,0x12,0x14,0x08,0x15,0x12,0x0D },	// &
+	{ 0x0C,0x04,0x08,0x00,0x00,0x00,0x00 },	// '
+	{ 0x02,0x04,0x08,0x08,0x08,0x04,0x02 },	// (
+	{ 0x08,0x04,0x02,0x02,0x02,0x04,0x08 },	// )
+	{ 0x00,0x04,0x15,0x0E,0x15,0x04,0x00 },	// *
+	{ 0x00,0x04,0x04,0x1F,0x04,0x04,0x00 },	// +
+	{ 0x00,0x00,0x00,0x00,0x0C,0x04,0x08 },	// ,
+	{ 0x00,0x00,0x00,0x1F,0x00,0x00,0x00 },	// -
+	{ 0x00,0x00,0x00,0x00,0x00,0x0C,0x0C },	// .
+	{ 0x00,0x01,0x02,0x04,0x08,0x10,0x00 },	// /
+	{ 0x0E,0x11,0x13,0x15,0x19,0x11,0x0E },	// 0
+	{ 0x04,0x0C,0x04,0x04,0x04,0x04,0x0E },	// 1
+	{ 0x0E,0x11,0x01,0x02,0x04,0x08,0x1F },	// 2
+	{ 0x1F,0x02,0x04,0x02,0x01,0x11,0x0E },	// 3
+	{ 0x02,0x06,0x0A,0x12,0x1F,0x02,0x02 },	// 4
+	{ 0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E },	// 5
+	{ 0x06,0x08,0x10,0x1E,0x11,0x11,0x0E },	// 6
+	{ 0x1F,0x01,0x02,0x04,0x08,0x08,0x08 },	// 7
+	{ 0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E },	// 8
+	{ 0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C },	// 9
+	{ 0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00 },	// :
+	{ 0x00,0x0C,0x0C,0x00,0x0C,0x04,0x08 },	// ;
+	{ 0x02,0x04,0x08,0x10,0x08,0x04,0x02 },	// <
+	{ 0x00,0x00,0x1F,0x00,0x1F,0x00,0x00 },	// =
+	{ 0x08,0x04,0x02,0x01,0x02,0x04,0x08 },	// >
+	{ 0x0E,0x11,0x01,0x02,0x04,0x00,0x04 },	// ?
+	{ 0x0E,0x11,0x01,0x0D,0x15,0x15,0x0E },	// @
+	{ 0x0E,0x11,0x11,0x1F,0x11,0x11,0x11 },	// A
+	{ 0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E },	// B
+	{ 0x0E,0x11,0x10,0x10,0x10,0x11,0x0E },	// C
+	{ 0x1C,0x12,0x11,0x11,0x11,0x12,0x1C },	// D
+	{ 0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F },	// E
+	{ 0x1F,0x10,0x10,0x1E,0x10,0x10,0x10 },	// F
+	{ 0x0E,0x11,0x10,0x17,0x11,0x11,0x0F },	// G
+	{ 0x11,0x11,0x11,0x1F,0x11,0x11,0x11 },	// H
+	{ 0x0E,0x04,0x04,0x04,0x04,0x04,0x0E },	// I
+	{ 0x07,0x02,0x02,0x02,0x02,0x12,0x0C },	// J
+	{ 0x11,0x12,0x14,0x18,0x14,0x12,0x11 },	// K
+	{ 0x10,0x10,0x10,0x10,0x10,0x10,0x1F },	// L
+	{ 0x11,0x1B,0x15,0x15,0x11,0x11,0x11 },	// M
+	{ 0x11,0x11,0x19,0x15,0x13,0x11,0x11 },	// N
+	{ 0x0E,0x11,0x11,0x11,0x11,0x11,0x0E },	// O
+	{ 0x1E,0x11,0x11,0x1E,0x10,0x10,0x10 },	// P
+	{ 0x0E,0x11,0x11,0x11,0x15,0x12,0x0D },	// Q
+	{ 0x1E,0x11,0x11,0x1E,0x14,0x12,0x11 },	// R
+	{ 0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E },	// S
+	{ 0x1F,0x04,0x04,0x04,0x04,0x04,0x04 },	// T
+	{ 0x11,0x11,0x11,0x11,0x11,0x11,0x0E },	// U
+	{ 0x11,0x11,0x11,0x11,0x11,0x0A,0x04 },	// V
+	{ 0x11,0x11,0x11,0x15,0x15,0x15,0x0A },	// W
+	{ 0x11,0x11,0x0A,0x04,0x0A,0x11,0x11 },	// X
+	{ 0x11,0x11,0x0A,0x04,0x04,0x04,0x04 },	// Y
+	{ 0x1F,0x01,0x02,0x04,0x08,0x10,0x1F },	// Z
+	{ 0x0E,0x08,0x08,0x08,0x08,0x08,0x0E },	// [
+	{ 0x00,0x10,0x08,0x04,0x02,0x01,0x00 },	// backslash
+	{ 0x0E,0x02,0x02,0x02,0x02,0x02,0x0E },	// ]
+	{ 0x04,0x0A,0x11,0x00,0x00,0x00,0x00 },	// ^
+	{ 0x00,0x00,0x00,0x00,0x00,0x00,0x1F },	// _
+	};
+
+	std::string Format( const char* format,double value )
+	{
+		char buffer[64];
+		snprintf( buffer,sizeof( buffer ),format,value );
+		return buffer;
+	}
+	std::string Count( long long value )
+	{
+		char buffer[32];
+		snprintf( buffer,sizeof( buffer ),"%lld",value );
+		return buffer;
+	}
+}
+
+constexpr unsigned int PerformanceOverlay::glyphWidth;
+constexpr unsigned int PerformanceOverlay::glyphHeight;
+constexpr Color PerformanceOverlay::backdrop;
+
+void PerformanceOverlay::Draw( RenderTarget& rt,const FrameTimer& ft,const PipelineStatistics* pCounters ) const
+{
+	const FrameTimer::Statistics stats = ft.GetStatistics();
+	const int x = int( 8u * scale );
+	int y = int( 8u * scale );
+	const Color label = Colors::Gray;
+	const Color value = Colors::White;
+
+	// a band over the full width behind the lines of text and the histogram
+	const int nLines = 3 + (stats.passes.empty() ? 0 : 1) + (pCounters ? 2 : 0);
+	BlendRect( rt,0,0,int( rt.GetRenderWidth() ),y + nLines * GetLineHeight() + int( (2u + 32u + 3u + 8u) * scale ),backdrop );
+
+	int cx = DrawText( rt,x,y,"frame ",label );
+	cx = DrawText( rt,cx,y,Format( "%.2f ms",stats.last * 1000.0 ),value );
+	DrawText( rt,cx,y,Format( "  (%.1f fps)",stats.mean > 0.0f ? 1.0 / stats.mean : 0.0 ),label );
+	y += GetLineHeight();
+
+	cx = DrawText( rt,x,y,"res ",label );
+	cx = DrawText( rt,cx,y,Count( rt.GetRenderWidth() ) + "x" + Count( rt.GetRenderHeight() ),value );
+	DrawText( rt,cx,y,Format( "  (%.0f%%)",rt.GetRenderScale() * 100.0 ),label );
+	y += GetLineHeight();
+
+	const std::pair<const char*,float> times[] = {
+		{ "mean ",stats.mean },{ "  p50 ",stats.p50 },{ "  p95 ",stats.p95 },{ "  p99 ",stats.p99 },{ "  worst ",stats.worst }
+	};
+	cx = x;
+	for( const auto& t : times )
+	{
+		cx = DrawText( rt,cx,y,t.first,label );
+		cx = DrawText( rt,cx,y,Format( "%.2f",t.second * 1000.0 ),value );
+	}
+	y += GetLineHeight();
+
+	if( !stats.passes.empty() )
+	{
+		cx = DrawText( rt,x,y,"passes",label );
+		for( size_t p = 0; p < stats.passes.size(); p++ )
+		{
+			cx = DrawText( rt,cx,y,"  " + Count( (long long)p ) + ": ",label );
+			cx = DrawText( rt,cx,y,Format( "%.2f",stats.passes[p] * 1000.0 ),value );
+		}
+		y += GetLineHeight();
+	}
+
+	if( pCounters )
+	{
+		const PipelineStatistics& c = *pCounters;
+		const std::pair<const char*,long long> geometry[] = {
+			{ "vs ",c.verticesShaded },{ "  tris ",c.trianglesAssembled },{ "  culled ",c.trianglesBackfaceCulled },
+			{ "  rejected ",c.trianglesTriviallyRejected },{ "  clipped ",c.trianglesClipped },{ "  raster ",c.subTrianglesGenerated }
+		};
+		const std::pair<const char*,long long> pixels[] = {
+			{ "px tested ",c.pixelsDepthTested },{ "  passed ",c.pixelsDepthPassed },{ "  shaded ",c.pixelsShaded }
+		};
+		cx = x;
+		for( const auto& v : geometry )
+		{
+			cx = DrawText( rt,cx,y,v.first,label );
+			cx = DrawText( rt,cx,y,Count( v.second ),value );
+		}
+		y += GetLineHeight();
+		cx = x;
+		for( const auto& v : pixels )
+		{
+			cx = DrawText( rt,cx,y,v.first,label );
+			cx = DrawText( rt,cx,y,Count( v.second ),value );
+		}
+		y += GetLineHeight();
+	}
+
+	DrawHistogram( rt,x,y + int( 2u * scale ),ft,stats );
+}
+
+int PerformanceOverlay::DrawText( RenderTarget& rt,int x,int y,const std::string& text,Color c ) const
+{
+	for( char ch : text )
+	{
+		DrawGlyph( rt,x + int( scale ),y + int( scale ),ch,Colors::Black );
+		DrawGlyph( rt,x,y,ch,c );
+		x += int( (glyphWidth + 1u) * scale );
+	}
+	return x;
+}
+
+void PerformanceOverlay::DrawGlyph( RenderTarget& rt,int x,int y,char ch,Color c ) const
+{
+	if( ch >= 'a' && ch <= 'z' )
+	{
+		ch = char( ch - 'a' + 'A' );
+	}
+	if( ch < ' ' || ch > '_' )
+	{
+		ch = '?';
+	}
+	const unsigned char* rows = font[ch - ' '];
+	for( unsigned int row = 0u; row < glyphHeight; row++ )
+	{
+		for( unsigned int col = 0u; col < glyphWidth; col++ )
+		{
+			if( rows[row] & (0x10u >> col) )
+			{
+				FillRect( rt,x + int( col * scale ),y + int( row * scale ),
+					x + int( (col + 1u) * scale ),y + int( (row + 1u) * scale ),c );
+			}
+		}
+	}
+}
+
+// [x0,x1) x [y0,y1), clipped to the target
+void PerformanceOverlay::FillRect( RenderTarget& rt,int x0,int y0,int x1,int y1,Color c ) const
+{
+	x0 = std::max( x0,0 );
+	y0 = std::max( y0,0 );
+	x1 = std::min( x1,int( rt.GetRenderWidth() ) );
+	y1 = std::min( y1,int( rt.GetRenderHeight() ) );
+	for( int y = y0; y < y1; y++ )
+	{
+		for( int x = x0; x < x1; x++ )
+		{
+			rt.PutPixel( x,y,c );
+		}
+	}
+}
+
+// [x0,x1) x [y0,y1) blended with the alpha of c, clipped to the target
+void PerformanceOverlay::BlendRect( RenderTarget& rt,int x0,int y0,int x1,int y1,Color c ) const
+{
+	x0 = std::max( x0,0 );
+	y0 = std::max( y0,0 );
+	x1 = std::min( x1,int( rt.GetRenderWidth() ) );
+	y1 = std::min( y1,int( rt.GetRenderHeight() ) );
+	if( x1 <= x0 )
+	{
+		return;
+	}
+	const std::vector<Color> row( size_t( x1 - x0 ),c );
+	for( int y = y0; y < y1; y++ )
+	{
+		rt.BlendRow( x0,y,x1 - x0,row.data() );
+	}
+}
+
+// one bar per bin up to twice the p99 (at least 33 ms), bars of frames slower
+// than p95 in red, baseline with a tick every 5 ms
+void PerformanceOverlay::DrawHistogram( RenderTarget& rt,int x,int y,const FrameTimer& ft,const FrameTimer::Statistics& stats ) const
+{
+	const std::vector<unsigned int>& histogram = ft.GetHistogram();
+	const unsigned int nBins = std::min( FrameTimer::nBins,
+		std::max( 132u,(unsigned int)(2.0f * stats.p99 / FrameTimer::binWidth) ) );
+	unsigned int highest = 1u;
+	for( unsigned int b = 0u; b < nBins; b++ )
+	{
+		highest = std::max( highest,histogram[b] );
+	}
+	const int height = int( 32u * scale );
+	const int barWidth = int( scale );
+	for( unsigned int b = 0u; b < nBins; b++ )
+	{
+		const int bx = x + int( b ) * barWidth;
+		const int barHeight = int( (long long)height * histogram[b] / highest );
+		const Color c = float( b ) * FrameTimer::binWidth > stats.p95 ? Colors::Red : Colors::Green;
+		FillRect( rt,bx,y + height - barHeight,bx + barWidth,y + height,c );
+		const bool tick = (b % (unsigned int)(0.005f / FrameTimer::binWidth + 0.5f)) == 0u;
+		FillRect( rt,bx,y + height,bx + barWidth,y + height + int( (tick ? 3u : 1u) * scale ),Colors::Gray );
+	}
+}
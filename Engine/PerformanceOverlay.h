@@ -0,0 +1,38 @@
+#pragma once
+
+#include "RenderTarget.h"
+#include "FrameTimer.h"
+#include "PipelineStatistics.h"
+#include <string>
+
+// frame statistics drawn straight into the frame with a small 5x7 bitmap font
+// draw it after the scene, right before EndFrame
+class PerformanceOverlay
+{
+public:
+	PerformanceOverlay( unsigned int scale = 1u )
+		:
+		scale( scale )
+	{}
+	// frame times, pass breakdown and rolling histogram of ft
+	// plus the pipeline counters of the frame when pCounters is given
+	void Draw( RenderTarget& rt,const FrameTimer& ft,const PipelineStatistics* pCounters = nullptr ) const;
+	// text with a one pixel shadow, lower case is drawn as upper case
+	// returns the x after the last character
+	int DrawText( RenderTarget& rt,int x,int y,const std::string& text,Color c ) const;
+	int GetLineHeight() const
+	{
+		return int( (glyphHeight + 2u) * scale );
+	}
+private:
+	void DrawGlyph( RenderTarget& rt,int x,int y,char ch,Color c ) const;
+	void FillRect( RenderTarget& rt,int x0,int y0,int x1,int y1,Color c ) const;
+	void BlendRect( RenderTarget& rt,int x0,int y0,int x1,int y1,Color c ) const;
+	void DrawHistogram( RenderTarget& rt,int x,int y,const FrameTimer& ft,const FrameTimer::Statistics& stats ) const;
+private:
+	static constexpr unsigned int glyphWidth = 5u;
+	static constexpr unsigned int glyphHeight = 7u;
+	// black at about 60%, darkens the frame behind the text
+	static constexpr Color backdrop = Color( 160,0,0,0 );
+	unsigned int scale;
+};
@@ -1,20 +1,26 @@
 #pragma once
 
 #include <algorithm>
-#include "ppl.h"
-#include "concrt.h"
+#include <utility>
+#include <vector>
+#include "ParallelFor.h"
 
-#include "ChiliWin.h"
-#include "Graphics.h"
+#include "RenderTarget.h"
 #include "Triangle.h"
 #include "IndexedTriangleList.h"
 #include "PubeScreenTransformer.h"
 #include "PerspectiveTransformer.h"
 #include "Mat3.h"
 #include "ExtendedVertex.h"
-#include "WBuffer.h"
-#include "StencilBuffer.h"
+#include "DepthStencilBuffer.h"
 #include "ClippingToolkit.h"
+#include "FixedPointEdges.h"
+#include "PipelineState.h"
+#include "PipelineTuning.h"
+#include "EffectTraits.h"
+#include "PipelineStatistics.h"
+#include "Profiler.h"
+#include "HardwareCounters.h"
 
 // triangle drawing pipeline with programable
 // pixel shading stage
@@ -26,39 +32,47 @@ public:
 	typedef typename Effect::Vertex Vertex;
 	typedef typename Effect::VertexShader::Output VSOut;
 	typedef typename Effect::GeometryShader::Output GSOut;
+	// raster state the effect fixes at compile time (EffectTraits.h)
+	typedef EffectTraits<Effect> Traits;
 public:
-	Pipeline(Graphics& gfx, WBuffer& zb, StencilBuffer& sb)
+	Pipeline(RenderTarget& gfx, DepthStencilBuffer& dsb)
 		:
 		gfx(gfx),
-		zb(zb),
-		sb(sb),
+		dsb(dsb),
+		pst(gfx.GetWidth(), gfx.GetHeight()),
 		perspt(-1.155f, 1.155f, -0.65f, 0.65f, -1.0f, -32.0f),
 		writeongfx(true),
-		turnfacing(false)
-	{
-		Concurrency::SchedulerPolicy sp(1, Concurrency::MaxConcurrency, 8);
-	}
+		turnfacing(false),
+		frontEndChunk(PipelineTuning::Current().frontEndChunk),
+		microBandRows(int(PipelineTuning::Current().microBandRows)),
+		batchMicroTriangles(ParallelThreadCount() > 1u)
+	{}
 
-	void Draw( IndexedTriangleList<Vertex>& triList )
+	void Draw( const IndexedTriangleList<Vertex>& triList )
 	{
+		PROFILE_ZONE( "Draw" );
+		// the render scale of the target may have changed since the last frame
+		pst = PubeScreenTransformer( gfx.GetRenderWidth(),gfx.GetRenderHeight() );
 		ProcessVertices( triList.vertices,triList.indices );
+		FlushMicroTriangles();
+		PIPELINE_STAT( CollectStatistics(); )
 	}
 
 	// needed to reset the z-buffer after each frame
 	void BeginFrame()
 	{
-		sb.Clear();
-		zb.Clear();
+		dsb.Clear();
+		PIPELINE_STAT( frameStatistics.Reset(); )
 	}
 
 	void switchZBufferSet(bool enableSet_in)
 	{
-		zb.enableSet = enableSet_in;
+		dsb.enableSet = enableSet_in;
 	}
 
 	void switchZBufferEqualTest( bool enableEqualTest_in)
 	{
-		zb.enableEqualTest = enableEqualTest_in;
+		dsb.enableEqualTest = enableEqualTest_in;
 	}
 
 	void switchWriteOnGFX(bool writeongfx_in)
@@ -71,45 +85,158 @@ public:
 		turnfacing = turnfacing_in;
 	}
 
+	// perspective divide only every span_in pixels (8 or 16 are good), with
+	// the attributes affine in between, 0 to divide at every pixel
+	// picked per triangle, ones with a large depth range keep dividing at every pixel
+	void switchPerspectiveSpan(int span_in)
+	{
+		perspectiveSpan = span_in;
+	}
+
+	// pixel coverage from vertices snapped to 1/256 pixel with the top-left
+	// rule (FixedPointEdges.h), pixels on the edges shared by two triangles get
+	// drawn exactly once, for passes that count coverage like stencil shadows
+	void switchFixedPointRaster(bool fixedPointRaster_in)
+	{
+		fixedPointRaster = fixedPointRaster_in;
+	}
+
+	void switchShadingRate(ShadingRate shadingRate_in)
+	{
+		shadingRate = shadingRate_in;
+	}
+
+	// per tile shading rates instead of the one of switchShadingRate,
+	// nullptr to go back (the image has to outlive the draws)
+	void bindShadingRateImage(const ShadingRateImage* pRateImage_in)
+	{
+		pRateImage = pRateImage_in;
+	}
+
+	// set all the switches at once
+	void switchState(const PipelineState& state)
+	{
+		switchZBufferSet(state.zBufferSet);
+		switchZBufferEqualTest(state.zBufferEqualTest);
+		switchWriteOnGFX(state.writeOnGFX);
+		switchTurnFacing(state.turnFacing);
+		switchShadingRate(state.shadingRate);
+		switchPerspectiveSpan(state.perspectiveSpan);
+		switchFixedPointRaster(state.fixedPointRaster);
+	}
+
+	PipelineState GetState() const
+	{
+		return PipelineState(dsb.enableSet, dsb.enableEqualTest, writeongfx, turnfacing, shadingRate, fixedPointRaster, perspectiveSpan);
+	}
+
+#ifdef PIPELINE_STATISTICS
+	// counters of the last Draw
+	const PipelineStatistics& GetDrawStatistics() const
+	{
+		return drawStatistics;
+	}
+	// counters of all the draws since BeginFrame
+	// (PipelineStatistics::FrameTotals() sums up every pipeline)
+	const PipelineStatistics& GetFrameStatistics() const
+	{
+		return frameStatistics;
+	}
+#endif
+
 private:
+	// clipped screen space triangles of one chunk of the stream, in stream order
+	class FrontEndBin
+	{
+	public:
+		std::vector<Triangle<GSOut>> triangles;
+#ifdef PIPELINE_STATISTICS
+		PipelineStatistics statistics;
+#endif
+	};
 	// vertex processing function
 	// transforms vertices using vs and then passes vtx & idx lists to triangle assembler
 	void ProcessVertices( const std::vector<Vertex>& vertices, const std::vector<size_t>& indices )
 	{
 		// transform vertices with VS and assemble triangles from stream of indices and vertices
-		AssembleTriangles( effect.vs(vertices, indices) );
+		PROFILE_ZONE_BEGIN( vsZone,"vertex shader" );
+		const auto shaded = [&]()
+		{
+			HW_COUNTER_STAGE( ProcessVertices );
+			return effect.vs(vertices, indices);
+		}();
+		PROFILE_ZONE_END( vsZone );
+		PIPELINE_STAT( frontEndStatistics.verticesShaded += (long long)shaded.vertices.size(); )
+		AssembleTriangles( shaded );
 	}
 	// triangle assembly function
-	// assembles indexed vertex stream into triangles and passes them to post process
-	// culls (does not send) back facing triangles
+	// assembles indexed vertex stream into triangles, runs gs and clipping on
+	// one chunk of them per thread, then draws the clipped triangles of the
+	// chunks in the order of the stream (the stencil ops and the equal depth
+	// test see the primitives in the order they were submitted)
+	// the stream goes through in rounds of frontEndChunk triangles per thread,
+	// so the bins stay small whatever the size of the mesh
 	void AssembleTriangles(const IndexedTriangleList<VSOut>& list)
 	{
-		// assemble triangles in the stream and process
-		for( size_t i = 0,end = list.indices.size() / 3;
-			 i < end; i++ )
+		const size_t nTriangles = list.indices.size() / 3;
+		const size_t nBins = ParallelThreadCount();
+		frontEndBins.resize( nBins );
+		for( size_t first = 0; first < nTriangles; first += nBins * frontEndChunk )
 		{
-			// determine triangle vertices via indexing
-			VSOut v0 = list.vertices[list.indices[i * 3]];
-			VSOut v1 = list.vertices[list.indices[i * 3 + 1]];
-			VSOut v2 = list.vertices[list.indices[i * 3 + 2]];
-			// avoid backfacing culling if it is enabled
-			if (turnfacing)
+			const size_t roundEnd = std::min( first + nBins * frontEndChunk,nTriangles );
+			const int nRoundBins = int( (roundEnd - first + frontEndChunk - 1) / frontEndChunk );
+			ParallelFor( 0, nRoundBins, [&]( int b )
 			{
-				std::swap(v1, v2);
-			}
-			// cull backfacing triangles with cross product (%) shenanigans and check if there are at least partially in front of the viewport
-			if(((v1.pos - v0.pos) % (v2.pos - v0.pos) * v0.pos <= 0.0f ) && (v0.pos.z <= -1.0f || v1.pos.z <= -1.0f || v2.pos.z <= -1.0f))
+				HW_COUNTER_STAGE( ProcessTriangle );
+				FrontEndBin& bin = frontEndBins[b];
+				bin.triangles.clear();
+				for( size_t i = first + b * frontEndChunk,end = std::min( i + frontEndChunk,roundEnd );
+					 i < end; i++ )
+				{
+					AssembleTriangle( list,i,bin );
+				}
+			});
+			for( int b = 0; b < nRoundBins; b++ )
 			{
-				// process 3 vertices into a triangle
-				ProcessTriangle( effect.gs(v0, v1, v2, i) );
+				for( const Triangle<GSOut>& triangle : frontEndBins[b].triangles )
+				{
+					DrawTriangle( triangle );
+				}
+				PIPELINE_STAT( frontEndStatistics += frontEndBins[b].statistics; )
+				PIPELINE_STAT( frontEndBins[b].statistics.Reset(); )
 			}
 		}
 	}
+	// assembles triangle i of the stream and passes it to gs and clipping
+	// culls (does not send) back facing triangles
+	void AssembleTriangle( const IndexedTriangleList<VSOut>& list,size_t i,FrontEndBin& bin )
+	{
+		// determine triangle vertices via indexing
+		VSOut v0 = list.vertices[list.indices[i * 3]];
+		VSOut v1 = list.vertices[list.indices[i * 3 + 1]];
+		VSOut v2 = list.vertices[list.indices[i * 3 + 2]];
+		// avoid backfacing culling if it is enabled
+		if (Traits::cullMode == CullMode::Dynamic ? turnfacing : Traits::cullMode == CullMode::Front)
+		{
+			std::swap(v1, v2);
+		}
+		// cull backfacing triangles with cross product (%) shenanigans and check if there are at least partially in front of the viewport
+		const bool frontFacing = (v1.pos - v0.pos) % (v2.pos - v0.pos) * v0.pos <= 0.0f;
+		PIPELINE_STAT( bin.statistics.trianglesAssembled++; )
+		PIPELINE_STAT( if( !frontFacing ) bin.statistics.trianglesBackfaceCulled++; )
+		if( frontFacing && (v0.pos.z <= -1.0f || v1.pos.z <= -1.0f || v2.pos.z <= -1.0f))
+		{
+			// process 3 vertices into a triangle
+			ProcessTriangle( effect.gs(v0, v1, v2, i),bin );
+		}
+		PIPELINE_STAT( else if( frontFacing ) bin.statistics.trianglesTriviallyRejected++; )
+	}
 	// triangle processing function
 	// takes 3 vertices to generate triangle
 	// sends generated triangle to post-processing
-	void ProcessTriangle(const Triangle<GSOut> defaultTriangle)
+	void ProcessTriangle(const Triangle<GSOut> defaultTriangle, FrontEndBin& bin)
 	{
+		PROFILE_ZONE_BEGIN( clipZone,"clipping" );
 		// store v0, v1, v2 at extented vertex that carries 1/z
 		ExtVertex<GSOut> EXTv0 (defaultTriangle.v0);
 		ExtVertex<GSOut> EXTv1 (defaultTriangle.v1);
@@ -149,6 +276,8 @@ private:
 		// move output at the device normalized space
 		// find where "you should look for points of the vectors"
 
+		PIPELINE_STAT( const bool nearClipped = EXTv0.Vertex.pos.z > 1.0f || EXTv1.Vertex.pos.z > 1.0f || EXTv2.Vertex.pos.z > 1.0f; )
+
 		OutCode shapeOutCode = 0;
 		OutCode pointsCommonSpace = trueAll;
 		for (auto& EXTv : output)
@@ -158,6 +287,8 @@ private:
 			pointsCommonSpace &= ClippingOutCode(EXTv.Vertex.pos);
 		}
 
+		PIPELINE_STAT( if (pointsCommonSpace) bin.statistics.trianglesTriviallyRejected++; )
+		PIPELINE_STAT( else if (nearClipped || (shapeOutCode & checkAllButNear)) bin.statistics.trianglesClipped++; )
 		if (!pointsCommonSpace)
 		{
 			if (shapeOutCode | checkAllButNear) 
@@ -256,14 +387,16 @@ private:
 			for (auto& eThis : output)
 				eThis.WtoVertexZ();
 
+			PROFILE_ZONE_END( clipZone );
 			// send all the triangles that created to render
+			PIPELINE_STAT( bin.statistics.subTrianglesGenerated += std::max(static_cast<int> (output.size()) - 2, 0); )
 			for (int i = 0, end = static_cast<int> (output.size()) - 2; i < end; i++) 
-				PostProcessTriangleVertices(Triangle<GSOut>{ output[0].Vertex, output[i + 1].Vertex, output[i + 2].Vertex });
+				PostProcessTriangleVertices(Triangle<GSOut>{ output[0].Vertex, output[i + 1].Vertex, output[i + 2].Vertex }, bin);
 		}
 	}
 	// vertex post-processing function
 	// perform perspective and viewport transformations
-	void PostProcessTriangleVertices( Triangle<GSOut>& triangle )
+	void PostProcessTriangleVertices( Triangle<GSOut> triangle,FrontEndBin& bin )
 	{
 
 		// perspective divide and screen transform for all 3 vertices
@@ -271,17 +404,164 @@ private:
 		pst.Transform( triangle.v1 );
 		pst.Transform( triangle.v2 );
 
-		// draw the triangle
-		DrawTriangle( triangle );
+		// queue the triangle for drawing
+		bin.triangles.push_back( triangle );
 	}
 	// === triangle rasterization functions ===
 	//   it0, it1, etc. stand for interpolants
 	//   (values which are interpolated across a triangle in screen space)
 	//
+	// attribute plane equations of a triangle, computed once in DrawTriangle
+	// the interpolant at screen point (x,y) is at0 + ddx * (x - x0) + ddy * (y - y0)
+	class Gradients
+	{
+	public:
+		GSOut At( float x,float y ) const
+		{
+			GSOut out = at0;
+			return out.AddScaled( ddx,x - at0.pos.x ).AddScaled( ddy,y - at0.pos.y );
+		}
+	public:
+		GSOut at0;
+		GSOut ddx;
+		GSOut ddy;
+	};
+	// x of a triangle edge along y
+	class Edge
+	{
+	public:
+		Edge( const Vec3& top,const Vec3& bottom )
+			:
+			x0( top.x ),
+			y0( top.y ),
+			dxdy( (bottom.x - top.x) / (bottom.y - top.y) )
+		{}
+		float At( float y ) const
+		{
+			return x0 + dxdy * (y - y0);
+		}
+	private:
+		float x0;
+		float y0;
+		float dxdy;
+	};
+	// rows [yStart,yEnd) a triangle gets drawn in, the whole render area or a
+	// band of the micro triangle batch
+	class RowBand
+	{
+	public:
+		int yStart;
+		int yEnd;
+	};
 	// entry point for tri rasterization
-	// sorts vertices, determines case, splits to flat tris, dispatches to flat tri funcs
-	void DrawTriangle( const Triangle<GSOut>& triangle)
+	// triangles of a few pixels only wait in a batch, so that they do not fork
+	// the workers one by one, the others get drawn right away (after the batch,
+	// the triangles keep their order on every pixel)
+	void DrawTriangle( const Triangle<GSOut>& triangle )
+	{
+		if( !batchMicroTriangles )
+		{
+			DrawTriangle( triangle,RowBand{ 0,int( gfx.GetRenderHeight() ) } );
+			return;
+		}
+		const float xMin = std::min( { triangle.v0.pos.x,triangle.v1.pos.x,triangle.v2.pos.x } );
+		const float xMax = std::max( { triangle.v0.pos.x,triangle.v1.pos.x,triangle.v2.pos.x } );
+		const float yMin = std::min( { triangle.v0.pos.y,triangle.v1.pos.y,triangle.v2.pos.y } );
+		const float yMax = std::max( { triangle.v0.pos.y,triangle.v1.pos.y,triangle.v2.pos.y } );
+		// the rows the triangle gets drawn in
+		const int yStart = fixedPointRaster ? FixedPointEdges::GetFirstRow( yMin ) : (int)ceil( yMin - 0.5f );
+		const int yEnd = fixedPointRaster ? FixedPointEdges::GetEndRow( yMax ) : (int)ceil( yMax - 0.5f );
+		if( yStart >= yEnd )
+		{
+			return;
+		}
+		if( xMax - xMin <= microTriangleSize && yMax - yMin <= microTriangleSize )
+		{
+			if( microTriangles.size() == microBatchSize )
+			{
+				FlushMicroTriangles();
+			}
+			microTriangles.push_back( triangle );
+			microRows.push_back( std::make_pair( yStart,yEnd ) );
+			return;
+		}
+		FlushMicroTriangles();
+		DrawTriangle( triangle,RowBand{ 0,int( gfx.GetRenderHeight() ) } );
+	}
+	// draws the batched micro triangles, every band of rows by one thread going
+	// through its triangles in order: no pixel is touched by two threads, and the
+	// depth / stencil results are the same as drawing them one by one
+	// (the ParallelFor of their rows runs nested, on the thread of the band)
+	void FlushMicroTriangles()
+	{
+		if( microTriangles.empty() )
+		{
+			return;
+		}
+		PROFILE_ZONE( "micro triangles" );
+		const int height = int( gfx.GetRenderHeight() );
+		const int bandRows = microBandRows;
+		const int nBands = (height + bandRows - 1) / bandRows;
+		// bands of triangle i are [first,last)
+		auto bandsOf = [&]( size_t i,int& first,int& last )
+		{
+			const int yStart = std::max( microRows[i].first,0 );
+			const int yEnd = std::min( microRows[i].second,height );
+			first = yStart / bandRows;
+			last = yEnd > yStart ? (yEnd - 1) / bandRows + 1 : first;
+		};
+		// bin the triangles by band, keeping their order inside every bin
+		bandStarts.assign( size_t( nBands ) + 1u,0u );
+		for( size_t i = 0; i < microTriangles.size(); i++ )
+		{
+			int first, last;
+			bandsOf( i,first,last );
+			for( int b = first; b < last; b++ )
+			{
+				bandStarts[b + 1]++;
+			}
+		}
+		activeBands.clear();
+		for( int b = 0; b < nBands; b++ )
+		{
+			if( bandStarts[b + 1] != 0u )
+			{
+				activeBands.push_back( b );
+			}
+			bandStarts[b + 1] += bandStarts[b];
+		}
+		bandTriangles.resize( bandStarts[nBands] );
+		bandFill.assign( bandStarts.begin(),bandStarts.end() - 1 );
+		for( size_t i = 0; i < microTriangles.size(); i++ )
+		{
+			int first, last;
+			bandsOf( i,first,last );
+			for( int b = first; b < last; b++ )
+			{
+				bandTriangles[bandFill[b]++] = (unsigned int)i;
+			}
+		}
+
+		ParallelFor( 0, int( activeBands.size() ), [&]( int a )
+		{
+			const int b = activeBands[a];
+			const RowBand band{ b * bandRows,std::min( b * bandRows + bandRows,height ) };
+			for( unsigned int t = bandStarts[b]; t < bandStarts[b + 1]; t++ )
+			{
+				DrawTriangle( microTriangles[bandTriangles[t]],band );
+			}
+		});
+		microTriangles.clear();
+		microRows.clear();
+	}
+	// sorts vertices, sets up the gradients and the edges, then scans over the
+	// rows of the triangle in screen space between its left and right edges,
+	// interpolates attributes, depth culls, invokes ps and writes the pixels to
+	// screen, only the rows of band get drawn
+	void DrawTriangle( const Triangle<GSOut>& triangle,const RowBand& band )
 	{
+		HW_COUNTER_STAGE( TriangleSetup );
+		PROFILE_ZONE( "raster" );
 		// using pointers so we can swap (for sorting purposes)
 		const GSOut* pv0 = &triangle.v0;
 		const GSOut* pv1 = &triangle.v1;
@@ -292,146 +572,306 @@ private:
 		if( pv2->pos.y < pv1->pos.y ) std::swap( pv1,pv2 );
 		if( pv1->pos.y < pv0->pos.y ) std::swap( pv0,pv1 );
 
-		if( pv0->pos.y == pv1->pos.y ) // natural flat top
+		// d/dx and d/dy of every interpolant from the two edges out of v0
+		// (cramer's rule), a zero area triangle covers no pixel centers
+		const auto e1 = *pv1 - *pv0;
+		const auto e2 = *pv2 - *pv0;
+		const float area = e1.pos.x * e2.pos.y - e2.pos.x * e1.pos.y;
+		if( area == 0.0f )
 		{
-			// sorting top vertices by x
-			if( pv1->pos.x < pv0->pos.x ) std::swap( pv0,pv1 );
-
-			DrawFlatTopTriangle( *pv0,*pv1,*pv2 );
-		}
-		else if( pv1->pos.y == pv2->pos.y ) // natural flat bottom
-		{
-			// sorting bottom vertices by x
-			if( pv2->pos.x < pv1->pos.x ) std::swap( pv1,pv2 );
-
-			DrawFlatBottomTriangle( *pv0,*pv1,*pv2 );
+			return;
 		}
-		else // general triangle
+		Gradients gradients;
+		gradients.at0 = *pv0;
+		gradients.ddx = (e1 * e2.pos.y - e2 * e1.pos.y) / area;
+		gradients.ddy = (e2 * e1.pos.x - e1 * e2.pos.x) / area;
+
+		// the attributes are recovered by dividing by the interpolated pos.z, affine
+		// steps between the divides are only close enough when that divisor keeps
+		// its sign and changes little over the triangle
+		int span = 0;
+		if( perspectiveSpan != 0 && Traits::needsAttributes )
 		{
-			// find splitting vertex interpolant
-			const float alphaSplit =
-				(pv1->pos.y - pv0->pos.y) /
-				(pv2->pos.y - pv0->pos.y);
-			const auto vi = interpolate( *pv0,*pv2,alphaSplit );
-
-			if( pv1->pos.x < vi.pos.x ) // major right
+			const float z0 = pv0->pos.z;
+			const float z1 = pv1->pos.z;
+			const float z2 = pv2->pos.z;
+			const bool sameSign = (z0 > 0.0f && z1 > 0.0f && z2 > 0.0f) || (z0 < 0.0f && z1 < 0.0f && z2 < 0.0f);
+			if( sameSign &&
+				std::max( { std::abs( z0 ),std::abs( z1 ),std::abs( z2 ) } ) <=
+				std::min( { std::abs( z0 ),std::abs( z1 ),std::abs( z2 ) } ) * maxSpanDepthRatio )
 			{
-				DrawFlatBottomTriangle( *pv0,*pv1,vi );
-				DrawFlatTopTriangle( *pv1,vi,*pv2 );
+				span = perspectiveSpan;
 			}
-			else // major left
+		}
+
+		if( fixedPointRaster )
+		{
+			const FixedPointEdges edges( pv0->pos,pv1->pos,pv2->pos );
+			if( !edges.IsEmpty() )
 			{
-				DrawFlatBottomTriangle( *pv0,vi,*pv1 );
-				DrawFlatTopTriangle( vi,*pv1,*pv2 );
+				const int width = int( gfx.GetRenderWidth() );
+				DrawRows( edges.GetFirstRow(),edges.GetEndRow(),[&edges,width]( int y,int& xStart,int& xEnd )
+				{
+					edges.GetRow( y,width,xStart,xEnd );
+				},gradients,span,band );
 			}
+			return;
 		}
-	}
-	// does flat *TOP* tri-specific calculations and calls DrawFlatTriangle
-	void DrawFlatTopTriangle( const GSOut& it0,
-							  const GSOut& it1,
-							  const GSOut& it2 )
-	{
-		// calulcate dVertex / dy
-		// change in interpolant for every 1 change in y
-		const float delta_y = it2.pos.y - it0.pos.y;
-		const auto dit0 = (it2 - it0) / delta_y;
-		const auto dit1 = (it2 - it1) / delta_y;
 
-		// create right edge interpolant
-		auto itEdge1 = it1;
+		// the long edge v0 v2 bounds one side of every row, the other side is
+		// v0 v1 down to the row of v1 and v1 v2 from there on, so the two flat
+		// parts are drawn by one loop (a flat top / flat bottom triangle never
+		// gets to the edge it does not have)
+		const Edge major( pv0->pos,pv2->pos );
+		const Edge upper = pv1->pos.y != pv0->pos.y ? Edge( pv0->pos,pv1->pos ) : major;
+		const Edge lower = pv2->pos.y != pv1->pos.y ? Edge( pv1->pos,pv2->pos ) : major;
+		const int ySplit = (int)ceil( pv1->pos.y - 0.5f );
+		// v1 right of the long edge
+		const bool majorLeft = area > 0.0f;
+
+		// calculate start and end scanlines
+		const int yStart = (int)ceil( pv0->pos.y - 0.5f );
+		const int yEnd = (int)ceil( pv2->pos.y - 0.5f );				// the scanline AFTER the last line drawn
 
-		// call the flat triangle render routine
-		DrawFlatTriangle( it0,it1,it2,dit0,dit1,itEdge1 );
+		DrawRows( yStart, yEnd, [&major,&upper,&lower,ySplit,majorLeft]( int y, int& xStart, int& xEnd )
+		{
+			const Edge& minor = y < ySplit ? upper : lower;
+			const Edge& left = majorLeft ? major : minor;
+			const Edge& right = majorLeft ? minor : major;
+			// calculate start and end pixels
+			const float yCenter = float( y ) + 0.5f;
+			xStart = (int)ceil( left.At( yCenter ) - 0.5f );
+			xEnd = (int)ceil( right.At( yCenter ) - 0.5f ); // the pixel AFTER the last pixel drawn
+		}, gradients, span, band );
 	}
-	// does flat *BOTTOM* tri-specific calculations and calls DrawFlatTriangle
-	void DrawFlatBottomTriangle( const GSOut& it0,
-								 const GSOut& it1,
-								 const GSOut& it2 )
+	// draws the rows [yStart,yEnd) of a triangle that are in band,
+	// extents( y,xStart,xEnd ) gives the pixels [xStart,xEnd) of row y
+	template<class Extents>
+	void DrawRows( int yStart,
+				   int yEnd,
+				   const Extents& extents,
+				   const Gradients& gradients,
+				   int span,
+				   const RowBand& band )
 	{
-		// calulcate dVertex / dy
-		// change in interpolant for every 1 change in y
-		const float delta_y = it2.pos.y - it0.pos.y;
-		const auto dit0 = (it1 - it0) / delta_y;
-		const auto dit1 = (it2 - it0) / delta_y;
-
-		// create right edge interpolant
-		auto itEdge1 = it0;
+		yStart = std::max( yStart, band.yStart );
+		yEnd = std::min( yEnd, band.yEnd );
 
-		// call the flat triangle render routine
-		DrawFlatTriangle( it0,it1,it2,dit0,dit1,itEdge1 );
+		// one raster loop per combination of the switches, picked here once
+		// (the ones the effect traits fix are not even compiled)
+		SelectToggle<Traits::depthWrite>( dsb.enableSet, [&]( auto depthWrite )
+		{
+			SelectToggle<EqualTestOf( Traits::depthTest )>( dsb.enableEqualTest, [&]( auto equalTest )
+			{
+				SelectToggle<Traits::colorWrite>( writeongfx, [&]( auto colorWrite )
+				{
+					this->template RasterizeRows<decltype( depthWrite )::value, decltype( equalTest )::value, decltype( colorWrite )::value>(
+						yStart, yEnd, extents, gradients, span );
+				});
+			});
+		});
 	}
-	// does processing common to both flat top and flat bottom tris
-	// scan over triangle in screen space, interpolate attributes,
-	// depth cull, invoke ps and write pixel to screen
-	void DrawFlatTriangle( const GSOut& it0,
-						   const GSOut& it1,
-						   const GSOut& it2,
-						   const GSOut& dv0,
-						   const GSOut& dv1,
-						   GSOut itEdge1 )
+	template<bool depthWrite, bool equalTest, bool colorWrite, class Extents>
+	void RasterizeRows( int yStart,
+						int yEnd,
+						const Extents& extents,
+						const Gradients& gradients,
+						int span )
 	{
-		// create edge interpolant for left edge (always v0)
-		auto itEdge0 = it0;
-
-		// calculate start and end scanlines
-		const int yStart = (int)ceil( it0.pos.y - 0.5f );
-		const int yEnd = (int)ceil( it2.pos.y - 0.5f );					// the scanline AFTER the last line drawn
-
-		// do interpolant prestep
-		itEdge0 += dv0 * (float( yStart ) + 0.5f - it0.pos.y);
-		itEdge1 += dv1 * (float( yStart ) + 0.5f - it0.pos.y);
-
-		Concurrency::parallel_for( 0, yEnd - yStart, [&](int t)
+		if( shadingRate == ShadingRate::Rate1x1 && pRateImage == nullptr )
 		{
-			int y = t + yStart;
-
-			auto itEdgeLoop0 = dv0 * (float)t + itEdge0;
-			auto itEdgeLoop1 = dv1 * (float)t + itEdge1;
-			// calculate start and end pixels
-			const int xStart = (int)ceil( itEdgeLoop0.pos.x - 0.5f );
-			const int xEnd = (int)ceil( itEdgeLoop1.pos.x - 0.5f ); // the pixel AFTER the last pixel drawn
-
-			// create scanline interpolant startpoint
-			// (some waste for interpolating x,y,z, but makes life easier not having
-			//  to split them off, and z will be needed in the future anyways...)
-			auto iLine = itEdgeLoop0;
-
-			// calculate delta scanline interpolant / dx
-			const float dx = itEdgeLoop1.pos.x - itEdgeLoop0.pos.x;
-			const auto diLine = (itEdgeLoop1 - iLine) / dx;
-
-			// prestep scanline interpolant
-			iLine += diLine * (float( xStart ) + 0.5f - itEdgeLoop0.pos.x);
+			// whole groups of rows that share tiles per thread (single rows when
+			// the target is row-major), so no two threads write the same tile
+			constexpr int groupShift = int( RenderTarget::rowGroupShift );
+			ParallelForChunks( yStart >> groupShift, ((yEnd - 1) >> groupShift) + 1, [&](int gFirst, int gLast)
+			{
+				HW_COUNTER_STAGE( Scanlines );
+				const int yLast = std::min( gLast << groupShift, yEnd );
+				for( int y = std::max( gFirst << groupShift, yStart ); y < yLast; y++ )
+				{
+					int xStart, xEnd;
+					extents( y, xStart, xEnd );
+					DrawScanline<depthWrite, equalTest, colorWrite>( y, xStart, xEnd, gradients, span, nullptr, 0u );
+				}
+			});
+		}
+		else if( yEnd > yStart )
+		{
+			// coarse shading: one thread owns every group of 4 rows (aligned on the
+			// screen like the blocks) so that the rows of a block share its color
+			ParallelForChunks( yStart >> 2, ((yEnd - 1) >> 2) + 1, [&](int gFirst, int gLast)
+			{
+				HW_COUNTER_STAGE( Scanlines );
+				thread_local std::vector<BlockColor> cache;
+				thread_local unsigned int stamp = 0u;
+				cache.resize( std::max( cache.size(), size_t( gfx.GetWidth() + gfx.GetWidth() / 4u + 2u ) ) );
+				for( int g = gFirst; g < gLast; g++ )
+				{
+					if( ++stamp == 0u )
+					{
+						// wrapped around, old entries could match again
+						cache.assign( cache.size(), BlockColor() );
+						stamp = 1u;
+					}
+					for( int y = std::max( g * 4, yStart ), yLast = std::min( g * 4 + 4, yEnd ); y < yLast; y++ )
+					{
+						int xStart, xEnd;
+						extents( y, xStart, xEnd );
+						DrawScanline<depthWrite, equalTest, colorWrite>( y, xStart, xEnd, gradients, span, cache.data(), stamp );
+					}
+				}
+			});
+		}
+	}
+	// shaded color of a block at a coarse shading rate, valid while stamp matches
+	class BlockColor
+	{
+	public:
+		Color color;
+		unsigned int stamp = 0u;
+	};
+	// pixels [xStart,xEnd) of scanline y, with pCache blocks of pixels get shaded once and share
+	// the color (cache indexes of coarse rates never overlap)
+	// span is the pixel count between perspective divides, 0 for every pixel
+	template<bool depthWrite, bool equalTest, bool colorWrite>
+	void DrawScanline( int y,
+					   int xStart,
+					   int xEnd,
+					   const Gradients& gradients,
+					   int span,
+					   BlockColor* pCache,
+					   unsigned int stamp )
+	{
+		// counted locally and added once per scanline to the thread's accumulator
+		PIPELINE_STAT( PipelineStatistics lineStatistics; )
+
+		const float yCenter = float( y ) + 0.5f;
+
+		// create scanline interpolant startpoint from the plane equations
+		// (some waste for interpolating x,y,z, but makes life easier not having
+		//  to split them off, and z will be needed in the future anyways...)
+		auto iLine = gradients.At( float( xStart ) + 0.5f,yCenter );
+		const auto& diLine = gradients.ddx;
+
+		// 2x2 blocks of the 4 row group come first in the cache, then the 4x4 ones
+		const int cacheRow2x2 = int( (gfx.GetWidth() + 1u) / 2u );
+		const int cacheRow = (y & 2) ? cacheRow2x2 : 0;
+		const int cache4x4 = 2 * cacheRow2x2;
+
+		// the shader only has to run for the color or its stencil accesses
+		constexpr bool shade = colorWrite || Traits::stencilOp == StencilOp::Shader;
+		// colors go straight into the row (inside a tile when tiled)
+		RenderTarget::Row row;
+		if( colorWrite && xEnd > xStart )
+			row = gfx.GetRow( y,xStart,xEnd );
+
+		// depth test, shading (once per block at a coarse rate) and write of pixel x,
+		// attr() gives the perspective correct attributes of the pixel
+		auto drawPixel = [&]( int x, float depth, const auto& attr )
+		{
+			// do w rejection / update of w buffer
+			// skip shading step if w rejected (early w)
+			PIPELINE_STAT( lineStatistics.pixelsDepthTested++; )
+			if( dsb.template TestAndSet<depthWrite, equalTest>( x,y, depth) )
+			{
+				PIPELINE_STAT( lineStatistics.pixelsDepthPassed++; )
+				if( Traits::stencilOp == StencilOp::Increment )
+					dsb.increaseStencilAt( x,y );
+				else if( Traits::stencilOp == StencilOp::Decrement )
+					dsb.decreaseStencilAt( x,y );
+				if( !shade )
+					return;
+				// send a "smart" reference of stencil buffer
+				StencilBufferPtr sbSmartPtr(x, y, dsb);
+				Color color;
+				const ShadingRate rate = pCache == nullptr ? ShadingRate::Rate1x1 :
+					pRateImage != nullptr ? pRateImage->At( x,y ) : shadingRate;
+				if( rate == ShadingRate::Rate1x1 )
+				{
+					// invoke pixel shader with interpolated vertex attributes
+					// and use result to set the pixel color on the screen
+					color = effect.ps( attr(), sbSmartPtr );
+					PIPELINE_STAT( lineStatistics.pixelsShaded++; )
+				}
+				else
+				{
+					BlockColor& block = pCache[rate == ShadingRate::Rate2x2 ? cacheRow + (x >> 1) : cache4x4 + (x >> 2)];
+					if( block.stamp != stamp )
+					{
+						block.color = effect.ps( attr(), sbSmartPtr );
+						block.stamp = stamp;
+						PIPELINE_STAT( lineStatistics.pixelsShaded++; )
+					}
+					color = block.color;
+				}
+				if( colorWrite )
+					row[x] = color;
+			}
+		};
 
-			for( int x = xStart; x < xEnd; x++,iLine = diLine + iLine)
+		if( span == 0 )
+		{
+			for( int x = xStart; x < xEnd; x++,iLine += diLine)
 			{
-				// do w rejection / update of w buffer
-				// skip shading step if w rejected (early w)
-				if( zb.TestAndSet( x,y, iLine.pos.z) )
+				drawPixel( x, iLine.pos.z, [&]()
 				{
+					if( !Traits::needsAttributes )
+						return iLine;
 					// recover z from 1/w
 					const float z = 1.0f / iLine.pos.z;
 					// recover interpolated attributes
 					// (wasted effort in multiplying pos (x,y,z) here, but
 					//  not a huge deal, not worth the code complication to fix)
-					const auto attr = iLine * z;
-					// invoke pixel shader with interpolated vertex attributes
-					// and use result to set the pixel color on the screen
-					// send a "smart" reference of stencil buffer
-					StencilBufferPtr sbSmartPtr(x, y, sb);
-					auto color(effect.ps(attr, sbSmartPtr));
-					if( writeongfx == true)
-						gfx.PutPixel(x, y, color);
+					return iLine * z;
+				});
+			}
+		}
+		else
+		{
+			// the perspective divide only at the ends of every span, the attributes
+			// are affine in between and brought up to a pixel only when it gets
+			// shaded (without the position, which pixel shaders do not read). depth
+			// takes the same per pixel steps as above, so passes with the equal test
+			// match whatever mode wrote the w buffer
+			float depth = iLine.pos.z;
+			GSOut attr = iLine * (1.0f / iLine.pos.z);
+			for( int x = xStart; x < xEnd; )
+			{
+				const int n = std::min( span, xEnd - x );
+				const GSOut iNext = GSOut( iLine ).AddScaled( diLine, float( n ) );
+				const GSOut attrNext = iNext * (1.0f / iNext.pos.z);
+				const GSOut dAttr = (attrNext - attr) / float( n );
+				int attrX = x;
+				for( const int spanEnd = x + n; x < spanEnd; x++,depth += diLine.pos.z )
+				{
+					drawPixel( x, depth, [&]() -> const GSOut&
+					{
+						attr.AddScaledAttributes( dAttr, float( x - attrX ) );
+						attrX = x;
+						return attr;
+					});
 				}
+				iLine = iNext;
+				attr = attrNext;
 			}
-		}, Concurrency::static_partitioner());
+		}
+		PIPELINE_STAT( rasterStatistics.Add( lineStatistics ); )
+	}
+#ifdef PIPELINE_STATISTICS
+	// gather the counters of the draw that just finished
+	void CollectStatistics()
+	{
+		drawStatistics = frontEndStatistics + rasterStatistics.Collect();
+		frontEndStatistics.Reset();
+		frameStatistics += drawStatistics;
+		PipelineStatistics::FrameTotals() += drawStatistics;
 	}
+#endif
 public:
 	Effect effect;
 private:
-	Graphics& gfx;
-	WBuffer& zb;
-	StencilBuffer& sb;
+	RenderTarget& gfx;
+	DepthStencilBuffer& dsb;
 	PubeScreenTransformer pst;
 	PerspectiveTransformer perspt;
 	Mat3 rotation;
@@ -441,4 +881,41 @@ private:
 
 	bool writeongfx;
 	bool turnfacing;
+	ShadingRate shadingRate = ShadingRate::Rate1x1;
+	const ShadingRateImage* pRateImage = nullptr;
+	int perspectiveSpan = 0;
+	bool fixedPointRaster = false;
+	// sizes of the parallel work, from the PipelineTuning current when the
+	// pipeline was built
+	// triangles of the stream a thread assembles and clips per round
+	size_t frontEndChunk;
+	// rows of a band of the micro triangle batch
+	int microBandRows;
+	// only worth it with threads to spread the bands over
+	bool batchMicroTriangles;
+	// triangles waiting to be drawn by FlushMicroTriangles, with the rows they can touch
+	std::vector<Triangle<GSOut>> microTriangles;
+	std::vector<std::pair<int,int>> microRows;
+	// the batch binned by bands of rows, triangles of band b are
+	// bandTriangles[bandStarts[b],bandStarts[b + 1])
+	std::vector<unsigned int> bandStarts;
+	std::vector<unsigned int> bandFill;
+	std::vector<unsigned int> bandTriangles;
+	std::vector<int> activeBands;
+	// one per thread, filled by AssembleTriangles
+	std::vector<FrontEndBin> frontEndBins;
+	// largest width / height in pixels of a triangle that goes to the batch
+	static constexpr float microTriangleSize = 4.0f;
+	static constexpr size_t microBatchSize = 1024u;
+	// largest ratio of the pos.z magnitudes of a triangle drawn with spans
+	static constexpr float maxSpanDepthRatio = 2.0f;
+
+#ifdef PIPELINE_STATISTICS
+	// front end counters get summed up from the bins on the drawing thread,
+	// raster counters come from every worker
+	PipelineStatistics frontEndStatistics;
+	PipelineStatisticsAccumulator rasterStatistics;
+	PipelineStatistics drawStatistics;
+	PipelineStatistics frameStatistics;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ShadingRate.h"
+
+// snapshot of the switchable pipeline state
+// (the same flags that the switch* functions of Pipeline set)
+class PipelineState
+{
+public:
+	PipelineState() = default;
+	PipelineState(bool zBufferSet, bool zBufferEqualTest, bool writeOnGFX, bool turnFacing,
+		ShadingRate shadingRate = ShadingRate::Rate1x1, bool fixedPointRaster = false, int perspectiveSpan = 0)
+		:
+		zBufferSet(zBufferSet),
+		zBufferEqualTest(zBufferEqualTest),
+		writeOnGFX(writeOnGFX),
+		turnFacing(turnFacing),
+		shadingRate(shadingRate),
+		fixedPointRaster(fixedPointRaster),
+		perspectiveSpan(perspectiveSpan)
+	{}
+	bool operator==(const PipelineState& rhs) const
+	{
+		return zBufferSet == rhs.zBufferSet &&
+			zBufferEqualTest == rhs.zBufferEqualTest &&
+			writeOnGFX == rhs.writeOnGFX &&
+			turnFacing == rhs.turnFacing &&
+			shadingRate == rhs.shadingRate &&
+			fixedPointRaster == rhs.fixedPointRaster &&
+			perspectiveSpan == rhs.perspectiveSpan;
+	}
+	bool operator!=(const PipelineState& rhs) const
+	{
+		return !(*this == rhs);
+	}
+public:
+	bool zBufferSet = true;
+	bool zBufferEqualTest = false;
+	bool writeOnGFX = true;
+	bool turnFacing = false;
+	ShadingRate shadingRate = ShadingRate::Rate1x1;
+	// coverage from snapped fixed point edges with the top-left rule
+	bool fixedPointRaster = false;
+	// pixels between perspective divides, 0 for every pixel
+	int perspectiveSpan = 0;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+// pipeline statistics counters (like d3d pipeline statistics queries)
+// define PIPELINE_STATISTICS to enable them, otherwise every PIPELINE_STAT()
+// in the pipeline expands to nothing and the counters cost nothing
+#ifdef PIPELINE_STATISTICS
+#define PIPELINE_STAT( statement ) statement
+#else
+#define PIPELINE_STAT( statement )
+#endif
+
+#ifdef PIPELINE_STATISTICS
+#include <array>
+#include <atomic>
+#endif
+
+class PipelineStatistics
+{
+public:
+	PipelineStatistics& operator+=(const PipelineStatistics& rhs)
+	{
+		verticesShaded += rhs.verticesShaded;
+		trianglesAssembled += rhs.trianglesAssembled;
+		trianglesBackfaceCulled += rhs.trianglesBackfaceCulled;
+		trianglesTriviallyRejected += rhs.trianglesTriviallyRejected;
+		trianglesClipped += rhs.trianglesClipped;
+		subTrianglesGenerated += rhs.subTrianglesGenerated;
+		pixelsDepthTested += rhs.pixelsDepthTested;
+		pixelsDepthPassed += rhs.pixelsDepthPassed;
+		pixelsShaded += rhs.pixelsShaded;
+		return *this;
+	}
+	PipelineStatistics operator+(const PipelineStatistics& rhs) const
+	{
+		return PipelineStatistics(*this) += rhs;
+	}
+	void Reset()
+	{
+		*this = PipelineStatistics();
+	}
+	// sum of every draw since the last ResetFrameTotals() (all pipelines)
+	static PipelineStatistics& FrameTotals()
+	{
+		static PipelineStatistics totals;
+		return totals;
+	}
+	static void ResetFrameTotals()
+	{
+		FrameTotals().Reset();
+	}
+public:
+	// vertices out of the vertex shader
+	long long verticesShaded = 0;
+	// triangles read from the index stream
+	long long trianglesAssembled = 0;
+	long long trianglesBackfaceCulled = 0;
+	// completely behind the near plane or outside one side of the frustum
+	long long trianglesTriviallyRejected = 0;
+	// crossing at least one plane of the frustum
+	long long trianglesClipped = 0;
+	// triangles sent to the rasterizer by ProcessTriangle
+	long long subTrianglesGenerated = 0;
+	long long pixelsDepthTested = 0;
+	long long pixelsDepthPassed = 0;
+	// pixel shader invocations
+	long long pixelsShaded = 0;
+};
+
+#ifdef PIPELINE_STATISTICS
+// per-thread accumulators for counters bumped from inside ParallelFor
+// every thread adds its local counts (once per scanline) to its own cache line,
+// Collect() sums the lines up after the parallel work has finished
+class PipelineStatisticsAccumulator
+{
+public:
+	void Add(const PipelineStatistics& local)
+	{
+		Slot& slot = slots[ThreadSlot()];
+		slot.counters[0].fetch_add(local.verticesShaded, std::memory_order_relaxed);
+		slot.counters[1].fetch_add(local.trianglesAssembled, std::memory_order_relaxed);
+		slot.counters[2].fetch_add(local.trianglesBackfaceCulled, std::memory_order_relaxed);
+		slot.counters[3].fetch_add(local.trianglesTriviallyRejected, std::memory_order_relaxed);
+		slot.counters[4].fetch_add(local.trianglesClipped, std::memory_order_relaxed);
+		slot.counters[5].fetch_add(local.subTrianglesGenerated, std::memory_order_relaxed);
+		slot.counters[6].fetch_add(local.pixelsDepthTested, std::memory_order_relaxed);
+		slot.counters[7].fetch_add(local.pixelsDepthPassed, std::memory_order_relaxed);
+		slot.counters[8].fetch_add(local.pixelsShaded, std::memory_order_relaxed);
+	}
+	// sum of all threads, resets the accumulators
+	PipelineStatistics Collect()
+	{
+		PipelineStatistics sum;
+		for (Slot& slot : slots)
+		{
+			sum.verticesShaded += slot.counters[0].exchange(0, std::memory_order_relaxed);
+			sum.trianglesAssembled += slot.counters[1].exchange(0, std::memory_order_relaxed);
+			sum.trianglesBackfaceCulled += slot.counters[2].exchange(0, std::memory_order_relaxed);
+			sum.trianglesTriviallyRejected += slot.counters[3].exchange(0, std::memory_order_relaxed);
+			sum.trianglesClipped += slot.counters[4].exchange(0, std::memory_order_relaxed);
+			sum.subTrianglesGenerated += slot.counters[5].exchange(0, std::memory_order_relaxed);
+			sum.pixelsDepthTested += slot.counters[6].exchange(0, std::memory_order_relaxed);
+			sum.pixelsDepthPassed += slot.counters[7].exchange(0, std::memory_order_relaxed);
+			sum.pixelsShaded += slot.counters[8].exchange(0, std::memory_order_relaxed);
+		}
+		return sum;
+	}
+private:
+	static constexpr unsigned int nSlots = 64u;
+	// threads get slots in the order they first count something
+	// (more than nSlots threads share slots, the adds are atomic so that stays correct)
+	static unsigned int ThreadSlot()
+	{
+		static std::atomic<unsigned int> nextSlot{ 0u };
+		static thread_local unsigned int slot = nextSlot.fetch_add(1u) % nSlots;
+		return slot;
+	}
+	struct alignas(64) Slot
+	{
+		std::array<std::atomic<long long>, 9> counters{};
+	};
+private:
+	std::array<Slot, nSlots> slots;
+};
+#endif
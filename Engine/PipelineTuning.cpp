@@ -0,0 +1,99 @@
+#include "PipelineTuning.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+const char* const PipelineTuning::defaultFile = "pipeline.cfg";
+
+bool PipelineTuning::Load( const std::string& filename )
+{
+	FILE* pFile = fopen( filename.c_str(),"r" );
+	if( pFile == nullptr )
+	{
+		return false;
+	}
+	char line[256];
+	while( fgets( line,sizeof( line ),pFile ) != nullptr )
+	{
+		char name[64];
+		unsigned int value;
+		if( line[0] == '#' || sscanf( line,"%63s %u",name,&value ) != 2 )
+		{
+			continue;
+		}
+		if( !strcmp( name,"threads" ) )
+		{
+			threads = value;
+		}
+		else if( !strcmp( name,"frontEndChunk" ) )
+		{
+			frontEndChunk = value;
+		}
+		else if( !strcmp( name,"microBandRows" ) )
+		{
+			microBandRows = value;
+		}
+		else if( !strcmp( name,"width" ) )
+		{
+			width = value;
+		}
+		else if( !strcmp( name,"height" ) )
+		{
+			height = value;
+		}
+	}
+	fclose( pFile );
+	Clamp();
+	return true;
+}
+
+bool PipelineTuning::Save( const std::string& filename ) const
+{
+	FILE* pFile = fopen( filename.c_str(),"w" );
+	if( pFile == nullptr )
+	{
+		return false;
+	}
+	const bool written = fprintf( pFile,
+		"# pipeline tuning, written by RasterBenchmark --tune\n"
+		"threads %u\n"
+		"frontEndChunk %u\n"
+		"microBandRows %u\n"
+		"width %u\n"
+		"height %u\n",
+		threads,frontEndChunk,microBandRows,width,height ) > 0;
+	return fclose( pFile ) == 0 && written;
+}
+
+void PipelineTuning::Clamp()
+{
+	frontEndChunk = std::max( frontEndChunk,16u );
+	microBandRows = std::max( (microBandRows + 3u) & ~3u,4u );
+}
+
+const PipelineTuning& PipelineTuning::Current()
+{
+	return Instance();
+}
+
+void PipelineTuning::SetCurrent( const PipelineTuning& tuning )
+{
+	PipelineTuning& current = Instance();
+	current = tuning;
+	current.Clamp();
+	SetParallelThreadLimit( current.threads );
+}
+
+PipelineTuning& PipelineTuning::Instance()
+{
+	static PipelineTuning current = []()
+	{
+		// no file is fine, the defaults are the untuned pipeline
+		PipelineTuning tuning;
+		tuning.Load( defaultFile );
+		SetParallelThreadLimit( tuning.threads );
+		return tuning;
+	}();
+	return current;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+// sizes of the parallel work of the pipeline
+// the fastest ones depend on the cores, the caches and the resolution of the
+// machine: RasterBenchmark --tune times a standard workload with different
+// values and writes the winners to pipeline.cfg, every Pipeline built in a
+// later run (of any program started in that directory) reads them back
+//
+// file: one "name value" per line, # starts a comment, unknown names are
+// skipped and missing ones keep their defaults
+class PipelineTuning
+{
+public:
+	// false when the file can not be read (the values stay as they were)
+	bool Load( const std::string& filename );
+	bool Save( const std::string& filename ) const;
+	// moves the values into the range the pipeline can use
+	void Clamp();
+	// the tuning of the pipelines built from now on, read from defaultFile
+	// the first time it is asked for
+	static const PipelineTuning& Current();
+	// replaces the current tuning and applies its thread count to ParallelFor
+	static void SetCurrent( const PipelineTuning& tuning );
+public:
+	// threads a ParallelFor spreads over, the calling one included (0 for all of them)
+	unsigned int threads = 0u;
+	// triangles a thread assembles and clips per round of the front end
+	unsigned int frontEndChunk = 1024u;
+	// rows of a band of the micro triangle batch (a multiple of the 4 row groups of coarse shading)
+	unsigned int microBandRows = 16u;
+	// render size the values were tuned at, only informative
+	unsigned int width = 0u;
+	unsigned int height = 0u;
+public:
+	static const char* const defaultFile;
+private:
+	static PipelineTuning& Instance();
+};
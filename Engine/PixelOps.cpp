@@ -0,0 +1,273 @@
+#include "PixelOps.h"
+#include <algorithm>
+#include <vector>
+
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( __i386__ )
+#define PIXELOPS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// msvc emits any intrinsic regardless of /arch
+#define PIXELOPS_AVX2
+#else
+#define PIXELOPS_AVX2 __attribute__(( target( "avx2" ) ))
+#endif
+#endif
+
+namespace
+{
+	void FillScalar( Color* pDst,size_t count,Color c )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			pDst[i] = c;
+		}
+	}
+	void BlendAlphaScalar( Color* pDst,const Color* pSrc,size_t count )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			pDst[i] = PixelOps::BlendAlpha( pDst[i],pSrc[i] );
+		}
+	}
+	void LerpScalar( Color* pDst,const Color* pA,const Color* pB,size_t count,unsigned int weight )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			pDst[i] = PixelOps::Lerp( pA[i],pB[i],weight );
+		}
+	}
+
+#ifdef PIXELOPS_X86
+	void FillSSE2( Color* pDst,size_t count,Color c )
+	{
+		const __m128i v = _mm_set1_epi32( int( c.dword ) );
+		size_t i = 0;
+		for( ; i + 4u <= count; i += 4u )
+		{
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i ),v );
+		}
+		FillScalar( pDst + i,count - i,c );
+	}
+	// 2 pixels of 4 channels in 16 bit lanes, the same steps as PixelOps::Blend
+	// (s * a + d * (255 - a) + 128 is at most 65153, no lane overflows)
+	__m128i Blend16SSE2( __m128i s,__m128i d )
+	{
+		const __m128i a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		const __m128i inv = _mm_sub_epi16( _mm_set1_epi16( 255 ),a );
+		const __m128i x = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( s,a ),_mm_mullo_epi16( d,inv ) ),_mm_set1_epi16( 128 ) );
+		return _mm_srli_epi16( _mm_add_epi16( x,_mm_srli_epi16( x,8 ) ),8 );
+	}
+	void BlendAlphaSSE2( Color* pDst,const Color* pSrc,size_t count )
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rgbMask = _mm_set1_epi32( 0x00FFFFFF );
+		size_t i = 0;
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i ) );
+			const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pDst + i ) );
+			const __m128i lo = Blend16SSE2( _mm_unpacklo_epi8( s,zero ),_mm_unpacklo_epi8( d,zero ) );
+			const __m128i hi = Blend16SSE2( _mm_unpackhi_epi8( s,zero ),_mm_unpackhi_epi8( d,zero ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i ),_mm_and_si128( _mm_packus_epi16( lo,hi ),rgbMask ) );
+		}
+		BlendAlphaScalar( pDst + i,pSrc + i,count - i );
+	}
+	// a * (256 - w) + b * w fits 16 bits, products are taken as low halves
+	void LerpSSE2( Color* pDst,const Color* pA,const Color* pB,size_t count,unsigned int weight )
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i w = _mm_set1_epi16( short( weight ) );
+		const __m128i inv = _mm_set1_epi16( short( 256u - weight ) );
+		size_t i = 0;
+		for( ; i + 4u <= count; i += 4u )
+		{
+			const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pA + i ) );
+			const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pB + i ) );
+			const __m128i lo = _mm_srli_epi16( _mm_add_epi16(
+				_mm_mullo_epi16( _mm_unpacklo_epi8( a,zero ),inv ),_mm_mullo_epi16( _mm_unpacklo_epi8( b,zero ),w ) ),8 );
+			const __m128i hi = _mm_srli_epi16( _mm_add_epi16(
+				_mm_mullo_epi16( _mm_unpackhi_epi8( a,zero ),inv ),_mm_mullo_epi16( _mm_unpackhi_epi8( b,zero ),w ) ),8 );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i ),_mm_packus_epi16( lo,hi ) );
+		}
+		LerpScalar( pDst + i,pA + i,pB + i,count - i,weight );
+	}
+
+	PIXELOPS_AVX2 void FillAVX2( Color* pDst,size_t count,Color c )
+	{
+		const __m256i v = _mm256_set1_epi32( int( c.dword ) );
+		size_t i = 0;
+		for( ; i + 8u <= count; i += 8u )
+		{
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( pDst + i ),v );
+		}
+		FillScalar( pDst + i,count - i,c );
+	}
+	PIXELOPS_AVX2 __m256i Blend16AVX2( __m256i s,__m256i d )
+	{
+		const __m256i a = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( s,_MM_SHUFFLE( 3,3,3,3 ) ),_MM_SHUFFLE( 3,3,3,3 ) );
+		const __m256i inv = _mm256_sub_epi16( _mm256_set1_epi16( 255 ),a );
+		const __m256i x = _mm256_add_epi16( _mm256_add_epi16( _mm256_mullo_epi16( s,a ),_mm256_mullo_epi16( d,inv ) ),_mm256_set1_epi16( 128 ) );
+		return _mm256_srli_epi16( _mm256_add_epi16( x,_mm256_srli_epi16( x,8 ) ),8 );
+	}
+	// unpack and pack both work inside 128 bit lanes, so the pixel order survives
+	PIXELOPS_AVX2 void BlendAlphaAVX2( Color* pDst,const Color* pSrc,size_t count )
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i rgbMask = _mm256_set1_epi32( 0x00FFFFFF );
+		size_t i = 0;
+		for( ; i + 8u <= count; i += 8u )
+		{
+			const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pSrc + i ) );
+			const __m256i d = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pDst + i ) );
+			const __m256i lo = Blend16AVX2( _mm256_unpacklo_epi8( s,zero ),_mm256_unpacklo_epi8( d,zero ) );
+			const __m256i hi = Blend16AVX2( _mm256_unpackhi_epi8( s,zero ),_mm256_unpackhi_epi8( d,zero ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( pDst + i ),_mm256_and_si256( _mm256_packus_epi16( lo,hi ),rgbMask ) );
+		}
+		BlendAlphaSSE2( pDst + i,pSrc + i,count - i );
+	}
+	PIXELOPS_AVX2 void LerpAVX2( Color* pDst,const Color* pA,const Color* pB,size_t count,unsigned int weight )
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i w = _mm256_set1_epi16( short( weight ) );
+		const __m256i inv = _mm256_set1_epi16( short( 256u - weight ) );
+		size_t i = 0;
+		for( ; i + 8u <= count; i += 8u )
+		{
+			const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pA + i ) );
+			const __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pB + i ) );
+			const __m256i lo = _mm256_srli_epi16( _mm256_add_epi16(
+				_mm256_mullo_epi16( _mm256_unpacklo_epi8( a,zero ),inv ),_mm256_mullo_epi16( _mm256_unpacklo_epi8( b,zero ),w ) ),8 );
+			const __m256i hi = _mm256_srli_epi16( _mm256_add_epi16(
+				_mm256_mullo_epi16( _mm256_unpackhi_epi8( a,zero ),inv ),_mm256_mullo_epi16( _mm256_unpackhi_epi8( b,zero ),w ) ),8 );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( pDst + i ),_mm256_packus_epi16( lo,hi ) );
+		}
+		LerpSSE2( pDst + i,pA + i,pB + i,count - i,weight );
+	}
+
+	bool CpuHasAVX2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid( info,0 );
+		if( info[0] < 7 )
+		{
+			return false;
+		}
+		// the os has to save the ymm registers too
+		__cpuid( info,1 );
+		const int osxsaveAndAvx = (1 << 27) | (1 << 28);
+		if( (info[2] & osxsaveAndAvx) != osxsaveAndAvx || (_xgetbv( 0 ) & 6u) != 6u )
+		{
+			return false;
+		}
+		__cpuidex( info,7,0 );
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+	}
+#endif
+}
+
+void PixelOps::StretchRow( Color* pDst,size_t dstCount,const Color* pSrc,size_t srcCount )
+{
+	// source position of every destination pixel center in 16.16 fixed point
+	const long long step = ((long long)srcCount << 16) / (long long)dstCount;
+	long long pos = step / 2 - (1 << 15);
+	const long long last = ((long long)srcCount - 1) << 16;
+	for( size_t x = 0; x < dstCount; x++,pos += step )
+	{
+		const long long clamped = std::min( std::max( pos,0ll ),last );
+		const size_t x0 = size_t( clamped >> 16 );
+		const size_t x1 = std::min( x0 + 1u,srcCount - 1u );
+		pDst[x] = Lerp( pSrc[x0],pSrc[x1],(unsigned int)((clamped & 0xFFFF) >> 8) );
+	}
+}
+
+void PixelOps::Copy( Color* pDst,const Color* pSrc,size_t count )
+{
+	// Color has its own copy operations, so no memcpy, the loop gets vectorized
+	std::copy( pSrc,pSrc + count,pDst );
+}
+
+const PixelOps::KernelTable& PixelOps::Kernels()
+{
+	static const KernelTable kernels = SelectKernels();
+	return kernels;
+}
+
+PixelOps::KernelTable PixelOps::SelectKernels()
+{
+#ifdef PIXELOPS_X86
+	if( CpuHasAVX2() )
+	{
+		return { FillAVX2,BlendAlphaAVX2,LerpAVX2,"avx2" };
+	}
+	// every x86-64 cpu has sse2
+	return { FillSSE2,BlendAlphaSSE2,LerpSSE2,"sse2" };
+#else
+	return { FillScalar,BlendAlphaScalar,LerpScalar,"scalar" };
+#endif
+}
+
+const char* PixelOps::CheckKernels()
+{
+	std::vector<KernelTable> tables;
+#ifdef PIXELOPS_X86
+	tables.push_back( { FillSSE2,BlendAlphaSSE2,LerpSSE2,"sse2" } );
+	if( CpuHasAVX2() )
+	{
+		tables.push_back( { FillAVX2,BlendAlphaAVX2,LerpAVX2,"avx2" } );
+	}
+#endif
+	unsigned int seed = 12345u;
+	const auto random = [&seed]()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return seed;
+	};
+	// every length up to a few vectors of the widest kernel, so the tails get checked too
+	const size_t maxCount = 37u;
+	std::vector<Color> a( maxCount ),b( maxCount ),expected( maxCount ),result( maxCount );
+	const unsigned int weights[] = { 0u,1u,127u,128u,255u,256u };
+	for( const KernelTable& table : tables )
+	{
+		for( size_t count = 0u; count <= maxCount; count++ )
+		{
+			for( size_t i = 0u; i < maxCount; i++ )
+			{
+				a[i] = Color( random() );
+				b[i] = Color( random() );
+			}
+			const Color fill( random() );
+			expected.assign( maxCount,Color( 0u ) );
+			result.assign( maxCount,Color( 0u ) );
+			FillScalar( expected.data(),count,fill );
+			table.fill( result.data(),count,fill );
+			if( !std::equal( expected.begin(),expected.end(),result.begin(),[]( Color x,Color y ) { return x.dword == y.dword; } ) )
+			{
+				return table.name;
+			}
+			// the blend works in place, both start from the same destination row
+			expected.assign( b.begin(),b.end() );
+			result.assign( b.begin(),b.end() );
+			BlendAlphaScalar( expected.data(),a.data(),count );
+			table.blendAlpha( result.data(),a.data(),count );
+			if( !std::equal( expected.begin(),expected.end(),result.begin(),[]( Color x,Color y ) { return x.dword == y.dword; } ) )
+			{
+				return table.name;
+			}
+			for( unsigned int weight : weights )
+			{
+				LerpScalar( expected.data(),a.data(),b.data(),count,weight );
+				table.lerp( result.data(),a.data(),b.data(),count,weight );
+				if( !std::equal( expected.begin(),expected.end(),result.begin(),[]( Color x,Color y ) { return x.dword == y.dword; } ) )
+				{
+					return table.name;
+				}
+			}
+		}
+	}
+	return nullptr;
+}
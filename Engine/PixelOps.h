@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Colors.h"
+#include <cstddef>
+
+// whole-row pixel operations for surfaces and render targets
+// the kernel (avx2, sse2 or plain c++) is picked once at startup from what
+// the cpu supports, every call after that is one indirect call per row
+class PixelOps
+{
+public:
+	// every pixel of the row becomes c (any color, not only byte-uniform ones)
+	static void Fill( Color* pDst,size_t count,Color c )
+	{
+		Kernels().fill( pDst,count,c );
+	}
+	// pSrc over pDst with the alpha of every source pixel, the same result as
+	// the single pixel BlendAlpha below
+	static void BlendAlpha( Color* pDst,const Color* pSrc,size_t count )
+	{
+		Kernels().blendAlpha( pDst,pSrc,count );
+	}
+	// a + (b - a) * weight / 256 per channel, weight in [0,256]
+	static void Lerp( Color* pDst,const Color* pA,const Color* pB,size_t count,unsigned int weight )
+	{
+		Kernels().lerp( pDst,pA,pB,count,weight );
+	}
+	// bilinear horizontal resize of one row (pixel centers line up)
+	static void StretchRow( Color* pDst,size_t dstCount,const Color* pSrc,size_t srcCount );
+	// a plain copy already runs at memory bandwidth, no kernel of its own
+	static void Copy( Color* pDst,const Color* pSrc,size_t count );
+	// source c over destination d with the source alpha, rounded to nearest
+	// (c * a + d * (255 - a)) / 255 per channel, the result has alpha 0
+	// like every other color the pipeline writes
+	static Color BlendAlpha( Color d,Color c )
+	{
+		const unsigned int a = c.GetA();
+		return Color( Blend( c.GetR(),d.GetR(),a ),Blend( c.GetG(),d.GetG(),a ),Blend( c.GetB(),d.GetB(),a ) );
+	}
+	static Color Lerp( Color a,Color b,unsigned int weight )
+	{
+		const unsigned int inv = 256u - weight;
+		return Color(
+			(unsigned char)((a.GetA() * inv + b.GetA() * weight) >> 8u),
+			(unsigned char)((a.GetR() * inv + b.GetR() * weight) >> 8u),
+			(unsigned char)((a.GetG() * inv + b.GetG() * weight) >> 8u),
+			(unsigned char)((a.GetB() * inv + b.GetB() * weight) >> 8u) );
+	}
+	// "avx2", "sse2" or "scalar"
+	static const char* GetKernelName()
+	{
+		return Kernels().name;
+	}
+	// runs every kernel set the cpu supports on rows of random pixels and
+	// compares them with the plain c++ one, they have to be bit exact
+	// the name of the first set that differs, nullptr if they all match
+	static const char* CheckKernels();
+private:
+	class KernelTable
+	{
+	public:
+		void( *fill )(Color*,size_t,Color);
+		void( *blendAlpha )(Color*,const Color*,size_t);
+		void( *lerp )(Color*,const Color*,const Color*,size_t,unsigned int);
+		const char* name;
+	};
+private:
+	static unsigned char Blend( unsigned int c,unsigned int d,unsigned int a )
+	{
+		// x / 255 rounded, exact for x in [0,255 * 255]
+		const unsigned int x = c * a + d * (255u - a) + 128u;
+		return (unsigned char)((x + (x >> 8u)) >> 8u);
+	}
+	static const KernelTable& Kernels();
+	static KernelTable SelectKernels();
+};
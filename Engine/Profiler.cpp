@@ -0,0 +1,102 @@
+#include "Profiler.h"
+
+#ifdef PROFILER
+#include <cstdio>
+
+#ifndef PROFILER_RING_SIZE
+// zones kept per thread, older ones get overwritten
+#define PROFILER_RING_SIZE (1u << 16)
+#endif
+
+namespace
+{
+	void WriteEscaped(FILE* file, const char* text)
+	{
+		for (; *text; text++)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				fputc('\\', file);
+			}
+			fputc(*text, file);
+		}
+	}
+}
+
+Profiler::ThreadBuffer::ThreadBuffer(int tid)
+	:
+	events(PROFILER_RING_SIZE),
+	tid(tid)
+{}
+
+// buffers live until the end of the program, threads keep pointers to them
+std::mutex& Profiler::BuffersMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>>& Profiler::Buffers()
+{
+	static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+	return buffers;
+}
+
+Profiler::ThreadBuffer* Profiler::Register()
+{
+	std::lock_guard<std::mutex> lock(BuffersMutex());
+	auto& buffers = Buffers();
+	buffers.push_back(std::make_unique<ThreadBuffer>((int)buffers.size()));
+	return buffers.back().get();
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filename, unsigned int firstFrame, unsigned int lastFrame)
+{
+	FILE* file = fopen(filename.c_str(), "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(BuffersMutex());
+	fputs("{\"traceEvents\":[\n", file);
+	bool first = true;
+	for (const auto& pBuffer : Buffers())
+	{
+		const ThreadBuffer& buffer = *pBuffer;
+		if (buffer.name)
+		{
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"",
+				first ? "" : ",\n", buffer.tid);
+			WriteEscaped(file, buffer.name);
+			fputs("\"}}", file);
+			first = false;
+		}
+
+		// only the last events.size() zones are still in the ring
+		const unsigned long long head = buffer.head.load(std::memory_order_acquire);
+		const unsigned long long size = buffer.events.size();
+		for (unsigned long long i = head > size ? head - size : 0u; i < head; i++)
+		{
+			const Event& e = buffer.events[i % size];
+			if (e.frame < firstFrame || e.frame > lastFrame)
+			{
+				continue;
+			}
+			// chrome trace timestamps are in microseconds
+			fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+			WriteEscaped(file, e.name);
+			fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u",
+				buffer.tid, e.start / 1000.0, (e.end - e.start) / 1000.0, e.frame);
+			if (e.arg >= 0)
+			{
+				fprintf(file, ",\"arg\":%d", e.arg);
+			}
+			fputs("}}", file);
+			first = false;
+		}
+	}
+	fputs("\n]}\n", file);
+	return fclose(file) == 0;
+}
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+
+// frame profiler with scoped zones, dumped as chrome trace json
+// (open the file in chrome://tracing or ui.perfetto.dev)
+// define PROFILER to enable it, otherwise the PROFILE_* macros expand to nothing
+//
+// every thread records into its own ring buffer, so recording a zone
+// takes no lock (only the first zone of a thread registers its buffer)
+#ifdef PROFILER
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+public:
+	class Event
+	{
+	public:
+		const char* name;
+		long long start;
+		long long end;
+		unsigned int frame;
+		int arg;
+	};
+public:
+	// zones recorded from now on belong to the next frame
+	static void BeginFrame()
+	{
+		CurrentFrame().fetch_add(1u, std::memory_order_relaxed);
+	}
+	static unsigned int GetFrame()
+	{
+		return CurrentFrame().load(std::memory_order_relaxed);
+	}
+	// nanoseconds since the profiler was first used
+	static long long Now()
+	{
+		static const auto epoch = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch).count();
+	}
+	// name has to outlive the profiler (string literals)
+	static void Record(const char* name, long long start, long long end, int arg)
+	{
+		ThreadBuffer& buffer = Local();
+		const unsigned long long head = buffer.head.load(std::memory_order_relaxed);
+		buffer.events[head % buffer.events.size()] = Event{ name, start, end, GetFrame(), arg };
+		buffer.head.store(head + 1u, std::memory_order_release);
+	}
+	// shown as the thread name in the trace
+	static void SetThreadName(const char* name)
+	{
+		Local().name = name;
+	}
+	// writes the zones of the frames [firstFrame,lastFrame] that are still in the ring buffers
+	// call it between frames, zones recorded while writing may show up torn
+	static bool WriteChromeTrace(const std::string& filename, unsigned int firstFrame, unsigned int lastFrame);
+private:
+	class ThreadBuffer
+	{
+	public:
+		ThreadBuffer(int tid);
+	public:
+		std::vector<Event> events;
+		std::atomic<unsigned long long> head{ 0u };
+		int tid;
+		const char* name = nullptr;
+	};
+private:
+	static std::atomic<unsigned int>& CurrentFrame()
+	{
+		static std::atomic<unsigned int> frame{ 0u };
+		return frame;
+	}
+	static ThreadBuffer& Local()
+	{
+		static thread_local ThreadBuffer* pBuffer = Register();
+		return *pBuffer;
+	}
+	static ThreadBuffer* Register();
+	static std::mutex& BuffersMutex();
+	static std::vector<std::unique_ptr<ThreadBuffer>>& Buffers();
+};
+
+// records the time between construction and destruction (or End)
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name, int arg = -1)
+		:
+		name(name),
+		arg(arg),
+		start(Profiler::Now())
+	{}
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+	~ProfileZone()
+	{
+		End();
+	}
+	void End()
+	{
+		if (name)
+		{
+			Profiler::Record(name, start, Profiler::Now(), arg);
+			name = nullptr;
+		}
+	}
+private:
+	const char* name;
+	int arg;
+	long long start;
+};
+
+#define PROFILE_CONCAT_IMPL( a,b ) a##b
+#define PROFILE_CONCAT( a,b ) PROFILE_CONCAT_IMPL( a,b )
+// zone until the end of the enclosing scope, optional int argument shown in the trace
+#define PROFILE_ZONE( ... ) ProfileZone PROFILE_CONCAT( profileZone,__LINE__ )( __VA_ARGS__ )
+// zone that can be closed before the end of the scope with PROFILE_ZONE_END
+#define PROFILE_ZONE_BEGIN( zone,... ) ProfileZone zone( __VA_ARGS__ )
+#define PROFILE_ZONE_END( zone ) zone.End()
+#define PROFILE_FRAME() Profiler::BeginFrame()
+#define PROFILE_THREAD_NAME( name ) Profiler::SetThreadName( name )
+#else
+#define PROFILE_ZONE( ... )
+#define PROFILE_ZONE_BEGIN( zone,... )
+#define PROFILE_ZONE_END( zone )
+#define PROFILE_FRAME()
+#define PROFILE_THREAD_NAME( name )
+#endif
@@ -1,14 +1,13 @@
 #pragma once
 #include "Vec3.h"
-#include "Graphics.h"
 
 class PubeScreenTransformer
 {
 public:
-	PubeScreenTransformer()
+	PubeScreenTransformer( unsigned int width,unsigned int height )
 		:
-		xFactor( float( Graphics::ScreenWidth ) / 2.0f ),
-		yFactor( float( Graphics::ScreenHeight ) / 2.0f )
+		xFactor( float( width ) / 2.0f ),
+		yFactor( float( height ) / 2.0f )
 	{}
 	template<class Vertex>
 	Vertex& Transform( Vertex& v ) const
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "Surface.h"
+#include "Colors.h"
+#include "ClearTags.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// surface that the pipeline renders into
+// the size is a runtime property, implementations decide what
+// happens to the frame at BeginFrame / EndFrame
+//
+// the pipeline renders into the top left GetRenderWidth() x GetRenderHeight()
+// pixels, SetRenderScale() shrinks that area for dynamic resolution and
+// Present / GetSurface stretch it back to the full size with a bilinear filter
+//
+// with TILED_RENDER_TARGET the pixels are stored in tileSize x tileSize
+// tiles that are contiguous in memory, a triangle then touches fewer cache
+// lines than in row-major order. Present / GetSurface write the frame out
+// row-major again
+class RenderTarget
+{
+public:
+#ifdef TILED_RENDER_TARGET
+	static constexpr unsigned int tileShift = 3u;
+	static constexpr unsigned int tileSize = 1u << tileShift;
+	// rows that share tiles, the rasterizer gives every group to one thread
+	static constexpr unsigned int rowGroupShift = tileShift;
+#else
+	static constexpr unsigned int rowGroupShift = 0u;
+#endif
+	// one row of the frame for direct writes, Row[x] is pixel x of it. when
+	// tiled pFirst is the row inside the first tile and the next tile follows
+	// tileSize * tileSize pixels later, so a span is contiguous up to the end
+	// of every tile
+	class Row
+	{
+	public:
+		Color& operator[]( int x ) const
+		{
+#ifdef TILED_RENDER_TARGET
+			return pFirst[((unsigned( x ) >> tileShift) << (2u * tileShift)) + (unsigned( x ) & (tileSize - 1u))];
+#else
+			return pFirst[x];
+#endif
+		}
+	public:
+		Color* pFirst = nullptr;
+	};
+public:
+	RenderTarget( unsigned int width,unsigned int height )
+		:
+		target( width,height ),
+#ifdef TILED_RENDER_TARGET
+		tilesX( (width + tileSize - 1u) >> tileShift ),
+		tiles( size_t( tilesX ) * ((height + tileSize - 1u) >> tileShift) * tileSize * tileSize ),
+#endif
+		tags( int( width ),int( height ) ),
+		renderWidth( width ),
+		renderHeight( height )
+	{}
+	RenderTarget( const RenderTarget& ) = delete;
+	RenderTarget& operator=( const RenderTarget& ) = delete;
+	virtual ~RenderTarget() = default;
+	virtual void BeginFrame() = 0;
+	virtual void EndFrame() = 0;
+	void PutPixel( int x,int y,int r,int g,int b )
+	{
+		PutPixel( x,y,{ (unsigned char)r,(unsigned char)g,(unsigned char)b } );
+	}
+	void PutPixel( int x,int y,Color c )
+	{
+		tags.Validate( x,y,[this,y]( int xFirst,int count )
+		{
+			FillSpan( xFirst,y,count );
+		});
+		Pixel( x,y ) = c;
+	}
+	// pSrc over the pixels [x,x + count) of row y with the alpha of every source
+	// pixel (PixelOps::BlendAlpha), the pixels have to be inside the target
+	void BlendRow( int x,int y,int count,const Color* pSrc )
+	{
+		ValidateSpans( x,x + count,y );
+		BlendSpan( x,y,count,pSrc );
+	}
+	// row y for writes to the pixels [xStart,xEnd) without the clear tag check
+	// and address math of PutPixel per pixel, the spans of them that still wait
+	// for the clear color get it here
+	Row GetRow( int y,int xStart,int xEnd )
+	{
+		ValidateSpans( xStart,xEnd,y );
+		return Row{ RowStart( y ) };
+	}
+	// lazy, pixels that are not drawn this frame get the color at present
+	void Clear( Color c )
+	{
+		clearColor = c;
+		tags.Clear();
+	}
+	unsigned int GetWidth() const
+	{
+		return target.GetWidth();
+	}
+	unsigned int GetHeight() const
+	{
+		return target.GetHeight();
+	}
+	// only between frames (after EndFrame, before BeginFrame)
+	void SetRenderScale( float scale )
+	{
+		renderScale = std::min( std::max( scale,float( minRenderScale ) ),1.0f );
+		renderWidth = std::max( 1u,unsigned( float( GetWidth() ) * renderScale + 0.5f ) );
+		renderHeight = std::max( 1u,unsigned( float( GetHeight() ) * renderScale + 0.5f ) );
+	}
+	float GetRenderScale() const
+	{
+		return renderScale;
+	}
+	unsigned int GetRenderWidth() const
+	{
+		return renderWidth;
+	}
+	unsigned int GetRenderHeight() const
+	{
+		return renderHeight;
+	}
+	// row-major frame at the full size, with the spans still waiting for the clear color filled
+	const Surface& GetSurface() const
+	{
+		return const_cast<RenderTarget*>(this)->ResolveOutput();
+	}
+public:
+	static constexpr float minRenderScale = 0.25f;
+protected:
+	// copies the frame row-major to pDst at the full size
+	void Present( unsigned int dstPitch,unsigned char* const pDst ) const
+	{
+		if( renderWidth == GetWidth() && renderHeight == GetHeight() )
+		{
+			PresentRows( dstPitch,pDst );
+		}
+		else
+		{
+			const_cast<RenderTarget*>(this)->Resolve();
+			const_cast<RenderTarget*>(this)->Upscale( dstPitch,pDst );
+		}
+	}
+private:
+	void ValidateSpans( int xStart,int xEnd,int y )
+	{
+		for( int span = xStart & ~(ClearTags::spanWidth - 1); span < xEnd; span += ClearTags::spanWidth )
+		{
+			tags.Validate( span,y,[this,y]( int xFirst,int n )
+			{
+				FillSpan( xFirst,y,n );
+			});
+		}
+	}
+	// spans that were not drawn since the last clear are written with the
+	// clear color without touching the pixels
+	void PresentRows( unsigned int dstPitch,unsigned char* const pDst ) const
+	{
+		for( unsigned int y = 0; y < target.GetHeight(); y++ )
+		{
+			Color* const pDstLine = reinterpret_cast<Color*>( &pDst[size_t( dstPitch ) * y] );
+			for( unsigned int x = 0; x < target.GetWidth(); x += ClearTags::spanWidth )
+			{
+				const unsigned int count = std::min( unsigned( ClearTags::spanWidth ),target.GetWidth() - x );
+				if( tags.IsStale( int( x ),int( y ) ) )
+				{
+					PixelOps::Fill( pDstLine + x,count,clearColor );
+				}
+				else
+				{
+					CopySpan( x,y,count,pDstLine + x );
+				}
+			}
+		}
+	}
+private:
+#ifdef TILED_RENDER_TARGET
+	Color* RowStart( int y )
+	{
+		return &tiles[((size_t( y ) >> tileShift) * tilesX << (2u * tileShift)) + ((unsigned( y ) & (tileSize - 1u)) << tileShift)];
+	}
+	Color& Pixel( int x,int y )
+	{
+		return Row{ RowStart( y ) }[x];
+	}
+	const Color& Pixel( int x,int y ) const
+	{
+		return const_cast<RenderTarget*>(this)->Pixel( x,y );
+	}
+	// one row of a tile at a time, spans start on tile boundaries
+	void CopySpan( unsigned int x,unsigned int y,unsigned int count,Color* pDst ) const
+	{
+		for( unsigned int end = x + count; x < end; x += tileSize,pDst += tileSize )
+		{
+			PixelOps::Copy( pDst,&Pixel( int( x ),int( y ) ),std::min( tileSize,end - x ) );
+		}
+	}
+	void FillSpan( int x,int y,int count )
+	{
+		for( int end = x + count; x < end; x++ )
+		{
+			Pixel( x,y ) = clearColor;
+		}
+	}
+	// one row of a tile at a time
+	void BlendSpan( int x,int y,int count,const Color* pSrc )
+	{
+		for( const int end = x + count; x < end; )
+		{
+			const int n = std::min( int( tileSize - (unsigned( x ) & (tileSize - 1u)) ),end - x );
+			PixelOps::BlendAlpha( &Pixel( x,y ),pSrc,size_t( n ) );
+			x += n;
+			pSrc += n;
+		}
+	}
+	void Resolve()
+	{
+		PresentRows( target.GetPitch() * sizeof( Color ),reinterpret_cast<unsigned char*>( target.GetBufferPtr() ) );
+	}
+#else
+	Color* RowStart( int y )
+	{
+		return &target.GetBufferPtr()[size_t( y ) * target.GetPitch()];
+	}
+	Color& Pixel( int x,int y )
+	{
+		return RowStart( y )[x];
+	}
+	void CopySpan( unsigned int x,unsigned int y,unsigned int count,Color* pDst ) const
+	{
+		PixelOps::Copy( pDst,&target.GetBufferPtrConst()[size_t( y ) * target.GetPitch() + x],count );
+	}
+	void FillSpan( int x,int y,int count )
+	{
+		PixelOps::Fill( &Pixel( x,y ),count,clearColor );
+	}
+	void BlendSpan( int x,int y,int count,const Color* pSrc )
+	{
+		PixelOps::BlendAlpha( &Pixel( x,y ),pSrc,size_t( count ) );
+	}
+	void Resolve()
+	{
+		// only the area the pipeline renders into is ever read
+		for( unsigned int y = 0; y < renderHeight; y++ )
+		{
+			tags.ValidateRow( int( y ),[this,y]( int xFirst,int count )
+			{
+				FillSpan( xFirst,int( y ),count );
+			},int( renderWidth ) );
+		}
+	}
+#endif
+	// target holds the resolved render area here, every source row is
+	// stretched once and two of them are blended per output row
+	void Upscale( unsigned int dstPitch,unsigned char* const pDst )
+	{
+		for( auto& row : stretched )
+		{
+			row.resize( GetWidth() );
+		}
+		int rowOf[2] = { -1,-1 };
+		auto stretchedRow = [&]( int sy ) -> const Color*
+		{
+			for( int i = 0; i < 2; i++ )
+			{
+				if( rowOf[i] == sy )
+				{
+					return stretched[i].data();
+				}
+			}
+			// source rows only move down, the lower cached row is never needed again
+			const int i = rowOf[0] < rowOf[1] ? 0 : 1;
+			PixelOps::StretchRow( stretched[i].data(),GetWidth(),&target.GetBufferPtrConst()[size_t( sy ) * target.GetPitch()],renderWidth );
+			rowOf[i] = sy;
+			return stretched[i].data();
+		};
+		// source row of every output row center in 16.16 fixed point
+		const long long step = ((long long)renderHeight << 16) / (long long)GetHeight();
+		const long long last = ((long long)renderHeight - 1) << 16;
+		long long pos = step / 2 - (1 << 15);
+		for( unsigned int y = 0; y < GetHeight(); y++,pos += step )
+		{
+			const long long clamped = std::min( std::max( pos,0ll ),last );
+			const int y0 = int( clamped >> 16 );
+			const int y1 = std::min( y0 + 1,int( renderHeight ) - 1 );
+			const Color* const pRow0 = stretchedRow( y0 );
+			const Color* const pRow1 = stretchedRow( y1 );
+			PixelOps::Lerp( reinterpret_cast<Color*>( &pDst[size_t( dstPitch ) * y] ),pRow0,pRow1,GetWidth(),
+				unsigned( (clamped & 0xFFFF) >> 8 ) );
+		}
+	}
+	const Surface& ResolveOutput()
+	{
+		Resolve();
+		if( renderWidth == GetWidth() && renderHeight == GetHeight() )
+		{
+			return target;
+		}
+		if( !pUpscaled )
+		{
+			pUpscaled = std::make_unique<Surface>( GetWidth(),GetHeight() );
+		}
+		Upscale( pUpscaled->GetPitch() * sizeof( Color ),reinterpret_cast<unsigned char*>( pUpscaled->GetBufferPtr() ) );
+		return *pUpscaled;
+	}
+private:
+	// row-major pixels, or only the copy GetSurface returns when tiled
+	Surface target;
+#ifdef TILED_RENDER_TARGET
+	unsigned int tilesX;
+	std::vector<Color> tiles;
+#endif
+	ClearTags tags;
+	Color clearColor = Colors::Black;
+	float renderScale = 1.0f;
+	unsigned int renderWidth;
+	unsigned int renderHeight;
+	std::vector<Color> stretched[2];
+	// full size frame GetSurface returns while the render scale is below 1
+	std::unique_ptr<Surface> pUpscaled;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// picks the render scale of the next frame from the time the last frames
+// took to render, so that heavy frames stay inside the budget
+// the pixel work goes with the square of the scale, the scale follows the
+// square root of budget / time, quickly down and slowly back up
+class ResolutionGovernor
+{
+public:
+	ResolutionGovernor( float budget = 1.0f / 60.0f,float minScale = 0.5f )
+		:
+		budget( budget ),
+		minScale( minScale )
+	{}
+	// seconds the last frame took to render (without waiting for vsync),
+	// returns the scale for the next frame
+	float Update( float frameTime )
+	{
+		smoothed = smoothed > 0.0f ? smoothed + (frameTime - smoothed) * smoothing : frameTime;
+		// a single slow frame is enough to go down
+		const float time = std::max( smoothed,frameTime );
+		if( time > budget || time < budget * upThreshold )
+		{
+			const float target = scale * std::sqrt( budget * headroom / time );
+			scale = std::min( std::max( target,scale - maxStepDown ),scale + maxStepUp );
+			scale = std::min( std::max( scale,minScale ),1.0f );
+		}
+		return scale;
+	}
+	float GetScale() const
+	{
+		return scale;
+	}
+	float GetBudget() const
+	{
+		return budget;
+	}
+	void Reset()
+	{
+		scale = 1.0f;
+		smoothed = 0.0f;
+	}
+private:
+	static constexpr float smoothing = 0.1f;
+	// aim a bit below the budget and only grow well below it, no oscillation
+	static constexpr float headroom = 0.9f;
+	static constexpr float upThreshold = 0.75f;
+	static constexpr float maxStepDown = 0.1f;
+	static constexpr float maxStepUp = 0.02f;
+private:
+	float budget;
+	float minScale;
+	float scale = 1.0f;
+	float smoothed = 0.0f;
+};
@@ -1,9 +1,11 @@
 #pragma once
 #include "Keyboard.h"
 #include "Mouse.h"
-#include "Graphics.h"
+#include "RenderTarget.h"
 #include <string>
 
+class PendingAssets;
+
 class Scene
 {
 public:
@@ -11,6 +13,11 @@ public:
 		:
 		name( name )
 	{}
+	// a scene that loads assets hides this with a LoadAssets( assets,args... )
+	// for the arguments of its constructor after gfx, which starts their loads
+	// in the background (see LazyScene)
+	static void LoadAssets( PendingAssets& )
+	{}
 	virtual void Update( Keyboard& kbd,Mouse& mouse,float dt ) = 0;
 	virtual void Draw() = 0;
 	virtual ~Scene() = default;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+// coarse pixel shading: at a rate of NxN the pixel shader runs once per NxN
+// block of screen pixels, for the first pixel of the block that passes the
+// depth test, and its color goes to every other pixel of the block that
+// passes. depth is still tested per pixel, stencil reads / writes of the
+// shader only happen for the pixel it ran for, so keep stencil writing
+// passes at 1x1
+// the values are log2 of the block size
+enum class ShadingRate : unsigned char
+{
+	Rate1x1 = 0,
+	Rate2x2 = 1,
+	Rate4x4 = 2
+};
+
+// shading rate of every tileSize x tileSize tile of the screen
+class ShadingRateImage
+{
+public:
+	static constexpr unsigned int tileShift = 4u;
+	static constexpr unsigned int tileSize = 1u << tileShift;
+public:
+	ShadingRateImage( unsigned int width,unsigned int height,ShadingRate rate = ShadingRate::Rate1x1 )
+		:
+		tilesX( (width + tileSize - 1u) >> tileShift ),
+		tilesY( (height + tileSize - 1u) >> tileShift ),
+		rates( size_t( tilesX ) * tilesY,rate )
+	{}
+	void Set( unsigned int tx,unsigned int ty,ShadingRate rate )
+	{
+		rates[size_t( ty ) * tilesX + tx] = rate;
+	}
+	void Fill( ShadingRate rate )
+	{
+		rates.assign( rates.size(),rate );
+	}
+	// rate of the tile pixel (x,y) is in
+	ShadingRate At( int x,int y ) const
+	{
+		return rates[size_t( unsigned( y ) >> tileShift ) * tilesX + (unsigned( x ) >> tileShift)];
+	}
+	unsigned int GetTilesX() const
+	{
+		return tilesX;
+	}
+	unsigned int GetTilesY() const
+	{
+		return tilesY;
+	}
+private:
+	unsigned int tilesX;
+	unsigned int tilesY;
+	std::vector<ShadingRate> rates;
+};
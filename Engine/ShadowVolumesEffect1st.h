@@ -12,6 +12,20 @@ class ShadowVolumesEffect1st
 public:
 	typedef DefaultVertex Vertex;
 
+public:
+	// front faces of the volumes count up where they are in front of the scene,
+	// the pipeline does the stencil op and the pixel shader never runs
+	class Traits : public DefaultEffectTraits
+	{
+	public:
+		static constexpr DepthTest depthTest = DepthTest::LessEqual;
+		static constexpr Toggle depthWrite = Toggle::Off;
+		static constexpr Toggle colorWrite = Toggle::Off;
+		static constexpr CullMode cullMode = CullMode::Back;
+		static constexpr StencilOp stencilOp = StencilOp::Increment;
+		static constexpr bool needsAttributes = false;
+	};
+
 public:
 	// use custom vs to create Vertex shaders
 	typedef ShadowVolumesVertexShader<Vertex> VertexShader;
@@ -40,7 +54,6 @@ public:
 		template<class Input>
 		Color operator()(const Input& in, StencilBufferPtr& stencil) const
 		{
-			stencil.increase();
 			return Colors::Yellow;
 		}
 	};
@@ -11,6 +11,20 @@ class ShadowVolumesEffect2nd
 public:
 	typedef DefaultVertex Vertex;
 
+public:
+	// back faces of the volumes count down where they are in front of the scene,
+	// the pipeline does the stencil op and the pixel shader never runs
+	class Traits : public DefaultEffectTraits
+	{
+	public:
+		static constexpr DepthTest depthTest = DepthTest::LessEqual;
+		static constexpr Toggle depthWrite = Toggle::Off;
+		static constexpr Toggle colorWrite = Toggle::Off;
+		static constexpr CullMode cullMode = CullMode::Front;
+		static constexpr StencilOp stencilOp = StencilOp::Decrement;
+		static constexpr bool needsAttributes = false;
+	};
+
 public:
 	// use custom vs to create Vertex shaders
 	typedef ShadowVolumesVertexShader<Vertex> VertexShader;
@@ -39,7 +53,6 @@ public:
 		template<class Input>
 		Color operator()(const Input& in, StencilBufferPtr& stencil) const
 		{
-			stencil.decrease();
 			return Colors::Red;
 		}
 	};
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "Scene.h"
-#include "AddObjFileModelWithGS.h"
+#include "AssetRegistry.h"
 #include "Mat3.h"
 #include "Pipeline.h"
+#include "CommandList.h"
 #include "DrawFrameEffect.h"
 #include "ShadowVolumesEffect1st.h"
 #include "ShadowVolumesEffect2nd.h"
@@ -18,20 +19,26 @@ public:
 	typedef Pipeline<ShadowVolumesEffect2nd> PipelineSV2;
 	typedef Pipeline<DrawFrameEffect> PipelineDF;
 	typedef DefaultVertex Vertex;
+	typedef PipelineDF::Vertex VertexWithTC;
 public:
-	ShadowVolumesScene(Graphics& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
+	ShadowVolumesScene(RenderTarget& gfx, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
 		:
-		itlistWithTextures(AddObjFileModelWithGS::GetSkinnedFromObjFileWithGS<Vertex>(scale, odjfilename)),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipelinewb(gfx, zb, sb),
-		pipelinesv1(gfx, zb, sb),
-		pipelinesv2(gfx, zb, sb),
-		pipelinedf(gfx, zb, sb),
+		pModel(AssetRegistry::GetMeshWithTC<Vertex, VertexWithTC>(odjfilename, scale)),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipelinewb(gfx, dsb),
+		pipelinesv1(gfx, dsb),
+		pipelinesv2(gfx, dsb),
+		pipelinedf(gfx, dsb),
 		Scene("Textured Cube skinned using texture: " + std::string(imagefilename.begin(), imagefilename.end()))
 	{
 		pipelinedf.effect.ps.BindTexture(imagefilename);
 	}
+	// the assets the constructor takes from the AssetRegistry
+	static void LoadAssets(PendingAssets& assets, const std::wstring& odjfilename, const std::wstring& imagefilename, const float scale)
+	{
+		assets.Add(AssetRegistry::LoadMeshWithTC<Vertex, VertexWithTC>(odjfilename, scale));
+		assets.Add(AssetRegistry::LoadTexture(imagefilename));
+	}
 	virtual void Update(Keyboard& kbd, Mouse& mouse, float dt) override
 	{
 		Vei2 mouseDelta = mouse.GetPos() - mouseLastPosition;
@@ -138,72 +145,97 @@ public:
 	}
 	virtual void Draw() override
 	{
-		pipelinewb.BeginFrame();
 		// generate rotation matrix from euler angles
 		// translation from offset
 		const Mat3 rot =
 			Mat3::RotationX(theta_x) *
 			Mat3::RotationY(theta_y) *
 			Mat3::RotationZ(theta_z);
+		const Vec3 translation = { offset_x,offset_y,offset_z };
+		const Vec3 position = { positionX,positionY,positionZ };
 		Vec3 cameraDir = { +sin(cameraP) * sin(cameraH),  +cos(cameraP)  , +sin(cameraP) * cos(cameraH) };
-		// set pipeline transform for pipelineZB
-		pipelinewb.effect.vs.BindRotation(rot);
-		pipelinewb.effect.vs.BindTranslation({ offset_x,offset_y,offset_z });
-		pipelinewb.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
-		pipelinewb.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
-		// set pipeline transform and lightsource for pipelineSV1
-		pipelinesv1.effect.vs.BindRotation(rot);
-		pipelinesv1.effect.vs.BindTranslation({ offset_x,offset_y,offset_z });
-		pipelinesv1.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
-		pipelinesv1.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
-		pipelinesv1.effect.vs.BindLightSourcePosition({ 0.0f,10.0f,0.0f });
-		// set pipeline transform and lightsource for pipelineSV2
-		pipelinesv2.effect.vs.BindRotation(rot);
-		pipelinesv2.effect.vs.BindTranslation({ offset_x,offset_y,offset_z });
-		pipelinesv2.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
-		pipelinesv2.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
-		pipelinesv2.effect.vs.BindLightSourcePosition({ 0.0f,10.0f,0.0f });
-		// set pipeline transform for pipelineDF
-		pipelinedf.effect.vs.BindRotation(rot);
-		pipelinedf.effect.vs.BindTranslation({ offset_x,offset_y,offset_z });
-		pipelinedf.effect.vs.BindCameraPosition({ positionX,positionY,positionZ });
-		pipelinedf.effect.vs.BindCameraRotation(Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f }));
-		// set geometry shader for pipelineDF
-		pipelinedf.effect.gs.BindShader(itlistWithTextures.tc, itlistWithTextures.uvMapping);
+		const Mat3 cameraRot = Mat3::ChangeView(cameraDir, { 0.0f,1.0f,0.0f });
+		const Vec3 lightPosition = { 0.0f,10.0f,0.0f };
+		const Transforms transforms = { rot, translation, position, cameraRot };
+
+		// record the four passes, every pass gets its own transforms and state
+		// (all of them with fixed point coverage, so the stencil counts of the volume
+		// faces and the pixels of the equal tests line up exactly on shared edges)
+		// the w buffer and frame passes go to one list and the two volume passes to
+		// another, recorded on two threads, the queue runs the passes in order
+		ParallelFor(0, 2, [&](int i)
+		{
+			if (i == 0)
+			{
+				frameList.BeginFrame(pipelinewb, 0u);
+				// pass 0: fill the w buffer
+				frameList.Draw(pipelinewb, pModel->itlist, PipelineState(true, false, false, false, ShadingRate::Rate1x1, true),
+					[=](WBufferCreationEffect& effect)
+					{
+						transforms.Bind(effect.vs);
+					}, 0u);
+				// pass 3: draw the frame where z is equal to the w buffer
+				frameList.Draw(pipelinedf, pModel->welded, PipelineState(false, true, true, false, ShadingRate::Rate1x1, true),
+					[=](DrawFrameEffect& effect)
+					{
+						transforms.Bind(effect.vs);
+					}, 3u);
+			}
+			else
+			{
+				// pass 1: front faces of the shadow volumes increase stencil (the effect traits turn color writes off)
+				volumeList.Draw(pipelinesv1, pModel->itlist, PipelineState(false, true, false, false, ShadingRate::Rate1x1, true),
+					[=](ShadowVolumesEffect1st& effect)
+					{
+						transforms.Bind(effect.vs);
+						effect.vs.BindLightSourcePosition(lightPosition);
+					}, 1u);
+				// pass 2: back faces of the shadow volumes decrease stencil (the effect traits turn color writes off)
+				volumeList.Draw(pipelinesv2, pModel->itlist, PipelineState(false, true, false, true, ShadingRate::Rate1x1, true),
+					[=](ShadowVolumesEffect2nd& effect)
+					{
+						transforms.Bind(effect.vs);
+						effect.vs.BindLightSourcePosition(lightPosition);
+					}, 2u);
+			}
+		});
+
 		// render triangles
-		pipelinewb.switchZBufferSet(true);
-		pipelinewb.switchZBufferEqualTest(false);
-		pipelinewb.switchTurnFacing(false);
-		pipelinewb.switchWriteOnGFX(false);
-		pipelinewb.Draw(itlistWithTextures.itlist);
-
-		pipelinesv1.switchZBufferSet(false);
-		pipelinesv1.switchZBufferEqualTest(true);
-		pipelinesv1.switchTurnFacing(false);
-		pipelinesv1.switchWriteOnGFX(false);				// true for debugging
-		pipelinesv1.Draw(itlistWithTextures.itlist);
-
-		pipelinesv2.switchZBufferSet(false);
-		pipelinesv2.switchZBufferEqualTest(true);
-		pipelinesv2.switchTurnFacing(true);
-		pipelinesv2.switchWriteOnGFX(false);				// true for debugging
-		pipelinesv2.Draw(itlistWithTextures.itlist);
-		
-		pipelinedf.switchZBufferSet(false);
-		pipelinedf.switchZBufferEqualTest(true);
-		pipelinedf.switchTurnFacing(false);
-		pipelinedf.switchWriteOnGFX(true);
-		pipelinedf.Draw(itlistWithTextures.itlist);
+		commandQueue.Submit(frameList);
+		commandQueue.Submit(volumeList);
+		commandQueue.Execute();
 	}
 private:
-	IndexedTriangleListWithTC<Vertex> itlistWithTextures;
+	// the object and camera transforms every pass binds to its vertex shader
+	class Transforms
+	{
+	public:
+		template<class VertexShader>
+		void Bind(VertexShader& vs) const
+		{
+			vs.BindRotation(rot);
+			vs.BindTranslation(translation);
+			vs.BindCameraPosition(position);
+			vs.BindCameraRotation(cameraRot);
+		}
+	public:
+		Mat3 rot;
+		Vec3 translation;
+		Vec3 position;
+		Mat3 cameraRot;
+	};
+private:
+	std::shared_ptr<const IndexedTriangleListWithTC<Vertex, VertexWithTC>> pModel;
 	PipelineWB pipelinewb;
 	PipelineSV1 pipelinesv1;
 	PipelineSV2 pipelinesv2;
 	PipelineDF pipelinedf;
 
-	WBuffer zb;
-	StencilBuffer sb;
+	CommandList frameList;
+	CommandList volumeList;
+	CommandQueue commandQueue;
+
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
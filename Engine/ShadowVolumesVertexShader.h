@@ -1,6 +1,8 @@
 #pragma once
 
+#include "HardwareCounters.h"
 #include "IndexedTriangleList.h"
+#include "ParallelFor.h"
 
 template<class Vertex>
 class ShadowVolumesVertexShader
@@ -33,23 +35,25 @@ public:
 	{
 		std::vector<Output> vertices_out;
 
-		std::transform(vertices_in.begin(), vertices_in.end(),
-			vertices_in.begin(),
-			[&](const auto& lambdain) -> Vertex {return { (lambdain.pos * rotation + translation - position) * camerarotation, lambdain }; });
-
 		Vec3 lightsourceposition_use = (lightsourceposition - position) * camerarotation;
 
 		// Create the new vertices vector
-		std::vector<Vertex> volumes_new_points;
-		volumes_new_points.reserve(vertices_in.size());
+		std::vector<Vertex> volumes_new_points(vertices_in);
 
-		std::transform(vertices_in.begin(), vertices_in.end(),
-			volumes_new_points.begin(),
-			[&](const auto& lambdain) -> Vertex
+		// every vertex and its point pushed away from the light are computed on
+		// their own, so they get spread over the threads
+		// (each chunk counts under ProcessVertices on the thread that runs it)
+		ParallelForChunks(0, int(vertices_in.size()), [&](int begin, int end)
 		{
-			Vec3 direction(lambdain.pos.x - lightsourceposition_use.x, lambdain.pos.y - lightsourceposition_use.y, lambdain.pos.z - lightsourceposition_use.z);
-			Vertex result(direction.GetNormalized() * 64 + lightsourceposition_use);
-			return result;
+			HW_COUNTER_STAGE( ProcessVertices );
+			for (int i = begin; i < end; i++)
+			{
+				Vertex& v = vertices_in[i];
+				v = { (v.pos * rotation + translation - position) * camerarotation, v };
+
+				Vec3 direction(v.pos.x - lightsourceposition_use.x, v.pos.y - lightsourceposition_use.y, v.pos.z - lightsourceposition_use.z);
+				volumes_new_points[i] = Vertex(direction.GetNormalized() * 64 + lightsourceposition_use);
+			}
 		});
 
 		vertices_out.reserve(vertices_in.size() * 2);
@@ -64,7 +68,7 @@ public:
 		// Create vertices_codes
 		std::vector<size_t> indices_out;
 
-		unsigned __int8* vertices_codes = new unsigned __int8[vertices_in.size()];
+		unsigned char* vertices_codes = new unsigned char[vertices_in.size()];
 		memset(vertices_codes, 0, vertices_in.size());
 
 		bool* triangles_codes = new bool[indices_in.size() / 3];
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "ClearTags.h"
 
+// unsigned counts, so increments / decrements wrap modulo 256 by definition
 class StencilBuffer
 {
 public:
@@ -9,7 +14,8 @@ public:
 		:
 		width(width),
 		height(height),
-		pBuffer(new __int8[width*height])
+		pBuffer(new uint8_t[width*height]),
+		tags(width, height)
 	{}
 	~StencilBuffer()
 	{
@@ -18,10 +24,10 @@ public:
 	}
 	StencilBuffer(const StencilBuffer&) = delete;
 	StencilBuffer& operator=(const StencilBuffer&) = delete;
+	// lazy, spans get their zeros the first time they are touched
 	void Clear()
 	{
-		const int nStencils = width * height;
-		memset(pBuffer, 0, nStencils * sizeof(__int8));
+		tags.Clear();
 	}
 	bool At(int x, int y)
 	{
@@ -29,7 +35,7 @@ public:
 	//	assert(x < width);
 	//	assert(y >= 0);
 	//	assert(y < height);
-		return !(pBuffer[y * width + x]);
+		return !Value(x, y);
 	}
 	void increaseStencilAt(int x, int y)
 	{
@@ -37,7 +43,7 @@ public:
 	//	assert(x < width);
 	//	assert(y >= 0);
 	//	assert(y < height);
-		pBuffer[y * width + x]++;
+		Value(x, y)++;
 	}
 	void decreaseStencilAt(int x, int y)
 	{
@@ -45,38 +51,22 @@ public:
 	//	assert(x < width);
 	//	assert(y >= 0);
 	//	assert(y < height);
-		pBuffer[y * width + x]--;
+		Value(x, y)--;
 	}
 
 private:
-	int width;
-	int height;
-	__int8* pBuffer = nullptr;
-};
-
-class StencilBufferPtr 
-{
-public:
-	StencilBufferPtr(int x, int y, StencilBuffer& sb)
-		:
-		x(x),
-		y(y),
-		sbRef(sb)
-	{}
-	bool get()
-	{
-		return sbRef.At(x, y);
-	}
-	void increase()
+	uint8_t& Value(int x, int y)
 	{
-		sbRef.increaseStencilAt(x, y);
-	}
-	void decrease()
-	{
-		sbRef.decreaseStencilAt(x, y);
+		uint8_t* const pLine = pBuffer + y * width;
+		tags.Validate(x, y, [pLine](int xFirst, int count)
+		{
+			std::fill(pLine + xFirst, pLine + xFirst + count, uint8_t(0));
+		});
+		return pLine[x];
 	}
 private:
-	int x;
-	int y;
-	StencilBuffer& sbRef;
+	int width;
+	int height;
+	uint8_t* pBuffer = nullptr;
+	ClearTags tags;
 };
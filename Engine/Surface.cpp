@@ -18,19 +18,37 @@
 *	You should have received a copy of the GNU General Public License					  *
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
+#ifdef _WIN32
 #define FULL_WINTARD
 #include "ChiliWin.h"
+#endif
 #include "Surface.h"
 #include "ChiliException.h"
+#include "Profiler.h"
+#include <algorithm>
+#ifdef _WIN32
 namespace Gdiplus
 {
 	using std::min;
 	using std::max;
 }
 #include <gdiplus.h>
-#include <sstream>
 
 #pragma comment( lib,"gdiplus.lib" )
+#else
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#ifdef SURFACE_LIBJPEG
+#include <csetjmp>
+#include <jpeglib.h>
+#endif
+#ifdef SURFACE_LIBPNG
+#include <png.h>
+#endif
+#endif
+#include <sstream>
 
 void Surface::PutPixelAlpha( unsigned int x,unsigned int y,Color c )
 {
@@ -41,17 +59,14 @@ void Surface::PutPixelAlpha( unsigned int x,unsigned int y,Color c )
 	// load source pixel
 	const Color d = GetPixel( x,y );
 
-	// blend channels
-	const unsigned char rsltRed = (c.GetR() * c.GetA() + d.GetR() * (255u - c.GetA())) / 256u;
-	const unsigned char rsltGreen = (c.GetG() * c.GetA() + d.GetG() * (255u - c.GetA())) / 256u;
-	const unsigned char rsltBlue = (c.GetB() * c.GetA() + d.GetB() * (255u - c.GetA())) / 256u;
-
-	// pack channels back into pixel and fire pixel onto surface
-	PutPixel( x,y,{ rsltRed,rsltGreen,rsltBlue } );
+	// blend channels and fire pixel onto surface
+	PutPixel( x,y,PixelOps::BlendAlpha( d,c ) );
 }
 
+#ifdef _WIN32
 Surface Surface::FromFile( const std::wstring & name )
 {
+	PROFILE_ZONE( "load texture" );
 	unsigned int width = 0;
 	unsigned int height = 0;
 	unsigned int pitch = 0;
@@ -130,7 +145,7 @@ void Surface::Save( const std::wstring & filename ) const
 
 	CLSID bmpID;
 	GetEncoderClsid( L"image/bmp",&bmpID );
-	Gdiplus::Bitmap bitmap( width,height,pitch * sizeof( Color ),PixelFormat32bppARGB,(BYTE*)pBuffer.get() );
+	Gdiplus::Bitmap bitmap( width,height,pitch * sizeof( Color ),PixelFormat32bppARGB,(BYTE*)pPixels );
 	if( bitmap.Save( filename.c_str(),&bmpID,nullptr ) != Gdiplus::Status::Ok )
 	{
 		std::wstringstream ss;
@@ -139,19 +154,259 @@ void Surface::Save( const std::wstring & filename ) const
 	}
 }
 
+#else
+// without gdi+ uncompressed 24/32 bit bitmaps are always supported, .jpg and
+// .png files when cmake found libjpeg / libpng (SURFACE_LIBJPEG / SURFACE_LIBPNG)
+namespace
+{
+	std::string NarrowFilename( const std::wstring& name )
+	{
+		return std::string( name.begin(),name.end() );
+	}
+	unsigned int ReadLE( const unsigned char* p,int nBytes )
+	{
+		unsigned int v = 0u;
+		for( int i = nBytes - 1; i >= 0; i-- )
+		{
+			v = (v << 8u) | p[i];
+		}
+		return v;
+	}
+	void WriteLE( unsigned char* p,unsigned int v,int nBytes )
+	{
+		for( int i = 0; i < nBytes; i++ )
+		{
+			p[i] = (unsigned char)(v >> (8u * i));
+		}
+	}
+#ifdef SURFACE_LIBJPEG
+	// libjpeg reports errors by calling error_exit, which must not return
+	class JpegError
+	{
+	public:
+		jpeg_error_mgr mgr;
+		jmp_buf jump;
+	};
+	// the setjmp frames below hold no objects with destructors
+	bool JpegStart( jpeg_decompress_struct& info,JpegError& error,const std::vector<unsigned char>& data )
+	{
+		if( setjmp( error.jump ) )
+		{
+			return false;
+		}
+		jpeg_mem_src( &info,const_cast<unsigned char*>( data.data() ),(unsigned long)data.size() );
+		jpeg_read_header( &info,TRUE );
+		info.out_color_space = JCS_RGB;
+		jpeg_start_decompress( &info );
+		return true;
+	}
+	bool JpegReadRows( jpeg_decompress_struct& info,JpegError& error,Color* pPixels,unsigned char* pRow )
+	{
+		if( setjmp( error.jump ) )
+		{
+			return false;
+		}
+		while( info.output_scanline < info.output_height )
+		{
+			Color* const pOut = pPixels + size_t( info.output_scanline ) * info.output_width;
+			JSAMPROW row = pRow;
+			jpeg_read_scanlines( &info,&row,1 );
+			for( unsigned int x = 0; x < info.output_width; x++ )
+			{
+				pOut[x] = Color( 255u,pRow[3 * x],pRow[3 * x + 1],pRow[3 * x + 2] );
+			}
+		}
+		jpeg_finish_decompress( &info );
+		return true;
+	}
+	// nullptr if libjpeg can not decode the data
+	std::unique_ptr<Color[]> DecodeJpeg( const std::vector<unsigned char>& data,int& width,int& height )
+	{
+		jpeg_decompress_struct info;
+		JpegError error;
+		info.err = jpeg_std_error( &error.mgr );
+		error.mgr.error_exit = []( j_common_ptr pInfo )
+		{
+			longjmp( reinterpret_cast<JpegError*>( pInfo->err )->jump,1 );
+		};
+		jpeg_create_decompress( &info );
+		std::unique_ptr<Color[]> pBuffer;
+		if( JpegStart( info,error,data ) )
+		{
+			width = int( info.output_width );
+			height = int( info.output_height );
+			pBuffer = std::make_unique<Color[]>( size_t( width ) * height );
+			std::vector<unsigned char> row( size_t( width ) * 3u );
+			if( !JpegReadRows( info,error,pBuffer.get(),row.data() ) )
+			{
+				pBuffer.reset();
+			}
+		}
+		jpeg_destroy_decompress( &info );
+		return pBuffer;
+	}
+#endif
+#ifdef SURFACE_LIBPNG
+	// nullptr if libpng can not decode the data
+	std::unique_ptr<Color[]> DecodePng( const std::vector<unsigned char>& data,int& width,int& height )
+	{
+		png_image image;
+		memset( &image,0,sizeof( image ) );
+		image.version = PNG_IMAGE_VERSION;
+		if( !png_image_begin_read_from_memory( &image,data.data(),data.size() ) )
+		{
+			return nullptr;
+		}
+		// b,g,r,a bytes are the layout of Color
+		image.format = PNG_FORMAT_BGRA;
+		width = int( image.width );
+		height = int( image.height );
+		std::unique_ptr<Color[]> pBuffer = std::make_unique<Color[]>( size_t( width ) * height );
+		if( !png_image_finish_read( &image,nullptr,pBuffer.get(),0,nullptr ) )
+		{
+			png_image_free( &image );
+			return nullptr;
+		}
+		return pBuffer;
+	}
+#endif
+}
+
+Surface Surface::FromFile( const std::wstring & name )
+{
+	PROFILE_ZONE( "load texture" );
+	auto fail = [&name]( const wchar_t* reason )
+	{
+		std::wstringstream ss;
+		ss << L"Loading image [" << name << L"]: " << reason;
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+	};
+
+	FILE* pFile = fopen( NarrowFilename( name ).c_str(),"rb" );
+	if( pFile == nullptr )
+	{
+		fail( L"failed to load." );
+	}
+	std::vector<unsigned char> data;
+	{
+		unsigned char chunk[4096];
+		size_t nRead;
+		while( (nRead = fread( chunk,1u,sizeof( chunk ),pFile )) > 0u )
+		{
+			data.insert( data.end(),chunk,chunk + nRead );
+		}
+		fclose( pFile );
+	}
+
+#ifdef SURFACE_LIBJPEG
+	if( data.size() >= 3u && data[0] == 0xFFu && data[1] == 0xD8u && data[2] == 0xFFu )
+	{
+		int width = 0;
+		int height = 0;
+		std::unique_ptr<Color[]> pBuffer = DecodeJpeg( data,width,height );
+		if( !pBuffer )
+		{
+			fail( L"failed to decode jpeg." );
+		}
+		return Surface( width,height,width,std::move( pBuffer ) );
+	}
+#endif
+#ifdef SURFACE_LIBPNG
+	if( data.size() >= 8u && memcmp( data.data(),"\x89PNG\r\n\x1a\n",8u ) == 0 )
+	{
+		int width = 0;
+		int height = 0;
+		std::unique_ptr<Color[]> pBuffer = DecodePng( data,width,height );
+		if( !pBuffer )
+		{
+			fail( L"failed to decode png." );
+		}
+		return Surface( width,height,width,std::move( pBuffer ) );
+	}
+#endif
+	if( data.size() < 54u || data[0] != 'B' || data[1] != 'M' )
+	{
+		fail( L"unsupported image format (this build reads .bmp, and .jpg / .png when built with libjpeg / libpng)." );
+	}
+	const unsigned int dataOffset = ReadLE( &data[10],4 );
+	const int width = int( ReadLE( &data[18],4 ) );
+	const int rawHeight = int( ReadLE( &data[22],4 ) );
+	const unsigned int bpp = ReadLE( &data[28],2 );
+	const unsigned int compression = ReadLE( &data[30],4 );
+	if( (bpp != 24u && bpp != 32u) || (compression != 0u && compression != 3u) || width <= 0 || rawHeight == 0 )
+	{
+		fail( L"unsupported bitmap format." );
+	}
+	const bool bottomUp = rawHeight > 0;
+	const int height = bottomUp ? rawHeight : -rawHeight;
+	const unsigned int bytesPerPixel = bpp / 8u;
+	const unsigned int rowBytes = (width * bytesPerPixel + 3u) & ~3u;
+	if( data.size() < dataOffset + size_t( rowBytes ) * height )
+	{
+		fail( L"file is truncated." );
+	}
+
+	std::unique_ptr<Color[]> pBuffer = std::make_unique<Color[]>( width * height );
+	for( int y = 0; y < height; y++ )
+	{
+		const unsigned char* pRow = &data[dataOffset + size_t( rowBytes ) * (bottomUp ? height - 1 - y : y)];
+		for( int x = 0; x < width; x++ )
+		{
+			const unsigned char* p = pRow + x * bytesPerPixel;
+			pBuffer[y * width + x] = Color( bytesPerPixel == 4u ? p[3] : 255u,p[2],p[1],p[0] );
+		}
+	}
+
+	return Surface( width,height,width,std::move( pBuffer ) );
+}
+
+void Surface::Save( const std::wstring & filename ) const
+{
+	const unsigned int imageBytes = width * height * 4u;
+	unsigned char header[54] = {};
+	header[0] = 'B';
+	header[1] = 'M';
+	WriteLE( &header[2],54u + imageBytes,4 );
+	WriteLE( &header[10],54u,4 );
+	WriteLE( &header[14],40u,4 );
+	WriteLE( &header[18],width,4 );
+	WriteLE( &header[22],(unsigned int)(-int( height )),4 ); // top-down rows
+	WriteLE( &header[26],1u,2 );
+	WriteLE( &header[28],32u,2 );
+	WriteLE( &header[34],imageBytes,4 );
+
+	FILE* pFile = fopen( NarrowFilename( filename ).c_str(),"wb" );
+	bool ok = pFile != nullptr && fwrite( header,1u,sizeof( header ),pFile ) == sizeof( header );
+	for( unsigned int y = 0; ok && y < height; y++ )
+	{
+		ok = fwrite( &pPixels[pitch * y],sizeof( Color ),width,pFile ) == width;
+	}
+	if( pFile != nullptr )
+	{
+		fclose( pFile );
+	}
+	if( !ok )
+	{
+		std::wstringstream ss;
+		ss << L"Saving surface to [" << filename << L"]: failed to save.";
+		throw Exception( _CRT_WIDE( __FILE__ ),__LINE__,ss.str() );
+	}
+}
+#endif
+
 void Surface::Copy( const Surface & src )
 {
 	assert( width == src.width );
 	assert( height == src.height );
 	if( pitch == src.pitch )
 	{
-		memcpy( pBuffer.get(),src.pBuffer.get(),pitch * height * sizeof( Color ) );
+		PixelOps::Copy( pPixels,src.pPixels,pitch * height );
 	}
 	else
 	{
 		for( unsigned int y = 0; y < height; y++ )
 		{
-			memcpy( &pBuffer[pitch * y],&src.pBuffer[pitch * y],sizeof( Color )* width );
+			PixelOps::Copy( &pPixels[pitch * y],&src.pPixels[src.pitch * y],width );
 		}
 	}
 }
@@ -19,13 +19,18 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
+#ifdef _WIN32
 #include "ChiliWin.h"
+#endif
 #include "Colors.h"
 #include "Rect.h"
 #include "ChiliException.h"
+#include "PixelOps.h"
 #include <string>
 #include <assert.h>
 #include <memory>
+#include <cstring>
+#include <cstdint>
 
 
 class Surface
@@ -39,20 +44,23 @@ public:
 		virtual std::wstring GetExceptionType() const override { return L"Surface Exception"; }
 	};
 public:
+	// rows start on alignment byte boundaries when pitch is a multiple of it
 	Surface( unsigned int width,unsigned int height,unsigned int pitch )
 		:
-		pBuffer( std::make_unique<Color[]>( pitch * height ) ),
+		pBuffer( std::make_unique<Color[]>( pitch * height + alignment / sizeof( Color ) - 1u ) ),
+		pPixels( Align( pBuffer.get() ) ),
 		width( width ),
 		height( height ),
 		pitch( pitch )
 	{}
 	Surface( unsigned int width,unsigned int height )
 		:
-		Surface( width,height,width )
+		Surface( width,height,GetPitch( width,alignment ) )
 	{}
 	Surface( Surface&& source )
 		:
 		pBuffer( std::move( source.pBuffer ) ),
+		pPixels( source.pPixels ),
 		width( source.width ),
 		height( source.height ),
 		pitch( source.pitch )
@@ -64,7 +72,9 @@ public:
 		height = donor.height;
 		pitch = donor.pitch;
 		pBuffer = std::move( donor.pBuffer );
+		pPixels = donor.pPixels;
 		donor.pBuffer = nullptr;
+		donor.pPixels = nullptr;
 		return *this;
 	}
 	Surface& operator=( const Surface& ) = delete;
@@ -72,13 +82,16 @@ public:
 	{}
 	void Clear( Color fillValue  )
 	{
-		memset( pBuffer.get(),fillValue.dword,pitch * height * sizeof( Color ) );
+		for( unsigned int y = 0; y < height; y++ )
+		{
+			PixelOps::Fill( &pPixels[pitch * y],width,fillValue );
+		}
 	}
-	void Present( unsigned int dstPitch,BYTE* const pDst ) const
+	void Present( unsigned int dstPitch,unsigned char* const pDst ) const
 	{
 		for( unsigned int y = 0; y < height; y++ )
 		{
-			memcpy( &pDst[dstPitch * y],&pBuffer[pitch * y],sizeof(Color) * width );
+			PixelOps::Copy( reinterpret_cast<Color*>( &pDst[dstPitch * y] ),&pPixels[pitch * y],width );
 		}
 	}
 	void PutPixel( unsigned int x,unsigned int y,Color c )
@@ -87,7 +100,7 @@ public:
 	//	assert( y >= 0 );
 	//	assert( x < width );
 	//	assert( y < height );
-		pBuffer[y * pitch + x] = c;
+		pPixels[y * pitch + x] = c;
 	}
 	void PutPixelAlpha( unsigned int x,unsigned int y,Color c );
 	Color GetPixel( unsigned int x,unsigned int y ) const
@@ -96,7 +109,7 @@ public:
 	//	assert( y >= 0 );
 	//	assert( x < width );
 	//	assert( y < height );
-		return pBuffer[y * pitch + x];
+		return pPixels[y * pitch + x];
 	}
 	unsigned int GetWidth() const
 	{
@@ -112,15 +125,18 @@ public:
 	}
 	Color* GetBufferPtr()
 	{
-		return pBuffer.get();
+		return pPixels;
 	}
 	const Color* GetBufferPtrConst() const
 	{
-		return pBuffer.get();
+		return pPixels;
 	}
 	static Surface FromFile( const std::wstring& name );
 	void Save( const std::wstring& filename ) const;
 	void Copy( const Surface& src );
+public:
+	// row alignment in bytes of surfaces that pick their own pitch (one cache line)
+	static constexpr unsigned int alignment = 64u;
 private:
 	// calculate pixel pitch required for given byte aligment (must be multiple of 4 bytes)
 	static unsigned int GetPitch( unsigned int width,unsigned int byteAlignment )
@@ -129,15 +145,22 @@ private:
 		const unsigned int pixelAlignment = byteAlignment / sizeof( Color );
 		return width + ( pixelAlignment - width % pixelAlignment ) % pixelAlignment;
 	}
+	static Color* Align( Color* p )
+	{
+		return reinterpret_cast<Color*>( (reinterpret_cast<uintptr_t>( p ) + alignment - 1u) & ~uintptr_t( alignment - 1u ) );
+	}
 	Surface( unsigned int width,unsigned int height,unsigned int pitch,std::unique_ptr<Color[]> pBufferParam )
 		:
+		pBuffer( std::move( pBufferParam ) ),
+		pPixels( pBuffer.get() ),
 		width( width ),
 		height( height ),
-		pBuffer( std::move( pBufferParam ) ),
 		pitch( pitch )
 	{}
 private:
 	std::unique_ptr<Color[]> pBuffer;
+	// first pixel, pBuffer rounded up to alignment (loaded images are not padded)
+	Color* pPixels;
 	unsigned int width;
 	unsigned int height;
 	unsigned int pitch; // pitch is in PIXELS, not bytes!
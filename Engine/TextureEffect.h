@@ -2,15 +2,17 @@
 
 #include <cmath>
 #include "Pipeline.h"
+#include "AssetRegistry.h"
 #include "DefaultVertexShader.h"
 #include "DefaultGeometryShader.h"
+#include "AttributePack.h"
 
 // basic texture effect
 class TextureEffect
 {
 public:
 	// the vertex type that will be input into the pipeline
-	class Vertex
+	class Vertex : public AttributePack<Vertex,Vec3,Vec2>
 	{
 	public:
 		Vertex() = default;
@@ -28,46 +30,6 @@ public:
 			t( t ),
 			pos( pos )
 		{}
-		Vertex& operator+=( const Vertex& rhs )
-		{
-			pos += rhs.pos;
-			t += rhs.t;
-			return *this;
-		}
-		Vertex operator+( const Vertex& rhs ) const
-		{
-			return Vertex( *this ) += rhs;
-		}
-		Vertex& operator-=( const Vertex& rhs )
-		{
-			pos -= rhs.pos;
-			t -= rhs.t;
-			return *this;
-		}
-		Vertex operator-( const Vertex& rhs ) const
-		{
-			return Vertex( *this ) -= rhs;
-		}
-		Vertex& operator*=( float rhs )
-		{
-			pos *= rhs;
-			t *= rhs;
-			return *this;
-		}
-		Vertex operator*( float rhs ) const
-		{
-			return Vertex( *this ) *= rhs;
-		}
-		Vertex& operator/=( float rhs )
-		{
-			pos /= rhs;
-			t /= rhs;
-			return *this;
-		}
-		Vertex operator/( float rhs ) const
-		{
-			return Vertex( *this ) /= rhs;
-		}
 	public:
 		Vec3 pos;
 		Vec2 t;
@@ -95,16 +57,25 @@ public:
 				std::min((unsigned int)(in.t.y * tex_height + 0.5f), tex_yclamp )
 			);
 		}
+		// the texture of the file, shared with everything else that binds it
 		void BindTexture( const std::wstring& filename )
 		{
-			pTex = std::make_unique<Surface>( Surface::FromFile( filename ) );
+			BindTexture( AssetRegistry::GetTexture( filename ) );
+		}
+		void BindTexture( Surface tex )
+		{
+			BindTexture( std::make_shared<const Surface>( std::move( tex ) ) );
+		}
+		void BindTexture( std::shared_ptr<const Surface> pTex_in )
+		{
+			pTex = std::move( pTex_in );
 			tex_width = float( pTex->GetWidth() );
 			tex_height = float( pTex->GetHeight() );
 			tex_xclamp = (pTex->GetWidth() - 1);
 			tex_yclamp = (pTex->GetHeight() - 1);
 		}
 	private:
-		std::unique_ptr<Surface> pTex;
+		std::shared_ptr<const Surface> pTex;
 		float tex_width;
 		float tex_height;
 		unsigned int tex_xclamp;
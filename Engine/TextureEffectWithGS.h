@@ -2,160 +2,25 @@
 
 #include <cmath>
 #include "Pipeline.h"
+#include "AssetRegistry.h"
 #include "DefaultVertexShader.h"
+#include "DefaultGeometryShader.h"
+#include "VertexTypes.h"
 
 // basic texture effect
 class TextureEffectWithGS
 {
 public:
 	// the vertex type that will be input into the pipeline
-	class Vertex
-	{
-	public:
-		Vertex() = default;
-		Vertex(const Vec3& pos)
-			:
-			pos(pos)
-		{}
-		Vertex(const Vec3& pos, const Vertex& src)
-			:
-			pos(pos)
-		{}
-		Vertex& operator+=(const Vertex& rhs)
-		{
-			pos += rhs.pos;
-			return *this;
-		}
-		Vertex operator+(const Vertex& rhs) const
-		{
-			return Vertex(*this) += rhs;
-		}
-		Vertex& operator-=(const Vertex& rhs)
-		{
-			pos -= rhs.pos;
-			return *this;
-		}
-		Vertex operator-(const Vertex& rhs) const
-		{
-			return Vertex(*this) -= rhs;
-		}
-		Vertex& operator*=(float rhs)
-		{
-			pos *= rhs;
-			return *this;
-		}
-		Vertex operator*(float rhs) const
-		{
-			return Vertex(*this) *= rhs;
-		}
-		Vertex& operator/=(float rhs)
-		{
-			pos /= rhs;
-			return *this;
-		}
-		Vertex operator/(float rhs) const
-		{
-			return Vertex(*this) /= rhs;
-		}
-	public:
-		Vec3 pos;
-	};
-
-	class VertexWithTC
-	{
-	public:
-		VertexWithTC() = default;
-		VertexWithTC(const Vec3& pos)
-			:
-			pos(pos)
-		{}
-		VertexWithTC(const Vec3& pos, const VertexWithTC& src)
-			:
-			t(src.t),
-			pos(pos)
-		{}
-		VertexWithTC(const Vec3& pos, const Vec2& t)
-			:
-			t(t),
-			pos(pos)
-		{}
-		VertexWithTC& operator+=(const VertexWithTC& rhs)
-		{
-			pos += rhs.pos;
-			t += rhs.t;
-			return *this;
-		}
-		VertexWithTC operator+(const VertexWithTC& rhs) const
-		{
-			return VertexWithTC(*this) += rhs;
-		}
-		VertexWithTC& operator-=(const VertexWithTC& rhs)
-		{
-			pos -= rhs.pos;
-			t -= rhs.t;
-			return *this;
-		}
-		VertexWithTC operator-(const VertexWithTC& rhs) const
-		{
-			return VertexWithTC(*this) -= rhs;
-		}
-		VertexWithTC& operator*=(float rhs)
-		{
-			pos *= rhs;
-			t *= rhs;
-			return *this;
-		}
-		VertexWithTC operator*(float rhs) const
-		{
-			return VertexWithTC(*this) *= rhs;
-		}
-		VertexWithTC& operator/=(float rhs)
-		{
-			pos /= rhs;
-			t /= rhs;
-			return *this;
-		}
-		VertexWithTC operator/(float rhs) const
-		{
-			return VertexWithTC(*this) /= rhs;
-		}
-	public:
-		Vec3 pos;
-		Vec2 t;
-	};
+	// (the one of the shadow volume scenes, so they all share the welded model)
+	typedef DefaultVertexWithTC Vertex;
 
 	// default vs rotates and translates vertices
 	// does not touch attributes
 	typedef DefaultVertexShader<Vertex> VertexShader;
 
-	// custom gs gives every thriangles its texture coordinates
-
-	class GeometryShader
-	{
-	public:
-		void BindShader(const std::vector<Vec2>& tc_in, const std::vector<size_t>& uvMapping_in)
-		{
-			tc = tc_in;
-			uvMapping = uvMapping_in;
-		}
-	
-	public:
-		typedef VertexWithTC Output;
-	
-	public:
-		template<class Vertex>
-		Triangle<Output> operator()(const Vertex& in0, const Vertex& in1, const Vertex& in2, size_t triangle_index)
-		{
-			VertexWithTC out0(in0.pos, tc[uvMapping[triangle_index * 3]]);
-			VertexWithTC out1(in1.pos, tc[uvMapping[triangle_index * 3 + 1]]);
-			VertexWithTC out2(in2.pos, tc[uvMapping[triangle_index * 3 + 2]]);
-			return{ out0, out1, out2 };
-		}
-
-	private:
-		std::vector<Vec2> tc;
-		std::vector<size_t> uvMapping;
-	};
+	// the texture coordinates come with the vertices (welded at load time)
+	typedef DefaultGeometryShader<VertexShader::Output> GeometryShader;
 
 
 	// invoked for each pixel of a triangle
@@ -173,16 +38,25 @@ public:
 				std::min((unsigned int)(in.t.y * tex_height + 0.5f), tex_yclamp)
 			);
 		}
+		// the texture of the file, shared with everything else that binds it
 		void BindTexture(const std::wstring& filename)
 		{
-			pTex = std::make_unique<Surface>(Surface::FromFile(filename));
+			BindTexture(AssetRegistry::GetTexture(filename));
+		}
+		void BindTexture(Surface tex)
+		{
+			BindTexture(std::make_shared<const Surface>(std::move(tex)));
+		}
+		void BindTexture(std::shared_ptr<const Surface> pTex_in)
+		{
+			pTex = std::move(pTex_in);
 			tex_width = float(pTex->GetWidth());
 			tex_height = float(pTex->GetHeight());
 			tex_xclamp = (pTex->GetWidth() - 1);
 			tex_yclamp = (pTex->GetHeight() - 1);
 		}
 	private:
-		std::unique_ptr<Surface> pTex;
+		std::shared_ptr<const Surface> pTex;
 		float tex_width;
 		float tex_height;
 		unsigned int tex_xclamp;
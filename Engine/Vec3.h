@@ -30,16 +30,19 @@ class Vei3;
 class Vec3
 {
 public:
-	Vec3() {}
+	// the spare fourth lane is kept at 0, vertex attribute packs
+	// (AttributePack.h) do their arithmetic on all four lanes
+	Vec3()
+		:
+		mmvalue(_mm_setzero_ps())
+	{}
 	Vec3(float x, float y, float z)
 		:
-		x(x),
-		y(y),
-		z(z)
+		mmvalue(_mm_setr_ps(x, y, z, 0.0f))
 	{}
 	Vec3(const Vec3& vect)
 		:
-		Vec3(vect.x, vect.y, vect.z)
+		mmvalue(vect.mmvalue)
 	{}
 
 	operator Ved3();
@@ -78,9 +81,7 @@ public:
 	}
 	Vec3&	operator=(const Vec3 &rhs)
 	{
-		x = rhs.x;
-		y = rhs.y;
-		z = rhs.z;
+		mmvalue = rhs.mmvalue;
 		return *this;
 	}
 	Vec3&	operator+=(const Vec3 &rhs)
@@ -299,7 +300,7 @@ public:
 	}
 
 public:
-	__declspec(align(4 * sizeof(double))) struct
+	struct alignas(4 * sizeof(double))
 	{
 		double x;
 		double y;
@@ -440,7 +441,7 @@ public:
 	}
 
 public:
-	__declspec(align(4 * sizeof(int))) struct
+	struct alignas(4 * sizeof(int))
 	{
 		int x;
 		int y;
@@ -2,13 +2,14 @@
 
 #include "Pipeline.h"
 #include "DefaultVertexShader.h"
+#include "AttributePack.h"
 
 // color gradient effect between vertices
 class VertexColorEffect
 {
 public:
 	// the vertex type that will be input into the pipeline
-	class Vertex
+	class Vertex : public AttributePack<Vertex,Vec3,Vec3>
 	{
 	public:
 		Vertex() = default;
@@ -26,46 +27,6 @@ public:
 			color( color ),
 			pos( pos )
 		{}
-		Vertex& operator+=( const Vertex& rhs )
-		{
-			pos += rhs.pos;
-			color += rhs.color;
-			return *this;
-		}
-		Vertex operator+( const Vertex& rhs ) const
-		{
-			return Vertex( *this ) += rhs;
-		}
-		Vertex& operator-=( const Vertex& rhs )
-		{
-			pos -= rhs.pos;
-			color -= rhs.color;
-			return *this;
-		}
-		Vertex operator-( const Vertex& rhs ) const
-		{
-			return Vertex( *this ) -= rhs;
-		}
-		Vertex& operator*=( float rhs )
-		{
-			pos *= rhs;
-			color *= rhs;
-			return *this;
-		}
-		Vertex operator*( float rhs ) const
-		{
-			return Vertex( *this ) *= rhs;
-		}
-		Vertex& operator/=( float rhs )
-		{
-			pos /= rhs;
-			color /= rhs;
-			return *this;
-		}
-		Vertex operator/( float rhs ) const
-		{
-			return Vertex( *this ) /= rhs;
-		}
 	public:
 		Vec3 pos;
 		Vec3 color;
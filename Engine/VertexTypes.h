@@ -2,8 +2,9 @@
 
 #include <cmath>
 #include "Vec3.h"
+#include "AttributePack.h"
 
-class DefaultVertex
+class DefaultVertex : public AttributePack<DefaultVertex,Vec3>
 {
 public:
 	DefaultVertex() = default;
@@ -15,47 +16,11 @@ public:
 		:
 		pos(pos)
 	{}
-	DefaultVertex& operator+=(const DefaultVertex& rhs)
-	{
-		pos += rhs.pos;
-		return *this;
-	}
-	DefaultVertex operator+(const DefaultVertex& rhs) const
-	{
-		return DefaultVertex(*this) += rhs;
-	}
-	DefaultVertex& operator-=(const DefaultVertex& rhs)
-	{
-		pos -= rhs.pos;
-		return *this;
-	}
-	DefaultVertex operator-(const DefaultVertex& rhs) const
-	{
-		return DefaultVertex(*this) -= rhs;
-	}
-	DefaultVertex& operator*=(float rhs)
-	{
-		pos *= rhs;
-		return *this;
-	}
-	DefaultVertex operator*(float rhs) const
-	{
-		return DefaultVertex(*this) *= rhs;
-	}
-	DefaultVertex& operator/=(float rhs)
-	{
-		pos /= rhs;
-		return *this;
-	}
-	DefaultVertex operator/(float rhs) const
-	{
-		return DefaultVertex(*this) /= rhs;
-	}
 public:
 	Vec3 pos;
 };
 
-class DefaultVertexWithTC
+class DefaultVertexWithTC : public AttributePack<DefaultVertexWithTC,Vec3,Vec2>
 {
 public:
 	DefaultVertexWithTC() = default;
@@ -73,52 +38,12 @@ public:
 		t(t),
 		pos(pos)
 	{}
-	DefaultVertexWithTC& operator+=(const DefaultVertexWithTC& rhs)
-	{
-		pos += rhs.pos;
-		t += rhs.t;
-		return *this;
-	}
-	DefaultVertexWithTC operator+(const DefaultVertexWithTC& rhs) const
-	{
-		return DefaultVertexWithTC(*this) += rhs;
-	}
-	DefaultVertexWithTC& operator-=(const DefaultVertexWithTC& rhs)
-	{
-		pos -= rhs.pos;
-		t -= rhs.t;
-		return *this;
-	}
-	DefaultVertexWithTC operator-(const DefaultVertexWithTC& rhs) const
-	{
-		return DefaultVertexWithTC(*this) -= rhs;
-	}
-	DefaultVertexWithTC& operator*=(float rhs)
-	{
-		pos *= rhs;
-		t *= rhs;
-		return *this;
-	}
-	DefaultVertexWithTC operator*(float rhs) const
-	{
-		return DefaultVertexWithTC(*this) *= rhs;
-	}
-	DefaultVertexWithTC& operator/=(float rhs)
-	{
-		pos /= rhs;
-		t /= rhs;
-		return *this;
-	}
-	DefaultVertexWithTC operator/(float rhs) const
-	{
-		return DefaultVertexWithTC(*this) /= rhs;
-	}
 public:
 	Vec3 pos;
 	Vec2 t;
 };
 
-class DefaultVertexWithPhong
+class DefaultVertexWithPhong : public AttributePack<DefaultVertexWithPhong,Vec3,Vec3,Vec3,Vec3>
 {
 public:
 	DefaultVertexWithPhong() = default;
@@ -140,54 +65,6 @@ public:
 		tocamera(tocamera),
 		pos(pos)
 	{}
-	DefaultVertexWithPhong& operator+=(const DefaultVertexWithPhong& rhs)
-	{
-		pos += rhs.pos;
-		tolightsrc += rhs.tolightsrc;
-		tocamera += rhs.tocamera;
-		normal += rhs.normal;
-		return *this;
-	}
-	DefaultVertexWithPhong operator+(const DefaultVertexWithPhong& rhs) const
-	{
-		return DefaultVertexWithPhong(*this) += rhs;
-	}
-	DefaultVertexWithPhong& operator-=(const DefaultVertexWithPhong& rhs)
-	{
-		pos -= rhs.pos;
-		tolightsrc -= rhs.tolightsrc;
-		tocamera -= rhs.tocamera;
-		normal -= rhs.normal;
-		return *this;
-	}
-	DefaultVertexWithPhong operator-(const DefaultVertexWithPhong& rhs) const
-	{
-		return DefaultVertexWithPhong(*this) -= rhs;
-	}
-	DefaultVertexWithPhong& operator*=(float rhs)
-	{
-		pos *= rhs;
-		tolightsrc *= rhs;
-		tocamera *= rhs;
-		normal *= rhs;
-		return *this;
-	}
-	DefaultVertexWithPhong operator*(float rhs) const
-	{
-		return DefaultVertexWithPhong(*this) *= rhs;
-	}
-	DefaultVertexWithPhong& operator/=(float rhs)
-	{
-		pos /= rhs;
-		tolightsrc /= rhs;
-		normal /= rhs;
-		tocamera /= rhs;
-		return *this;
-	}
-	DefaultVertexWithPhong operator/(float rhs) const
-	{
-		return DefaultVertexWithPhong(*this) /= rhs;
-	}
 public:
 	Vec3 pos;
 	Vec3 tolightsrc;
@@ -195,7 +72,7 @@ public:
 	Vec3 normal;
 };
 
-class DefaultVertexWithPhongAndTC
+class DefaultVertexWithPhongAndTC : public AttributePack<DefaultVertexWithPhongAndTC,Vec3,Vec3,Vec3,Vec3,Vec2>
 {
 public:
 	DefaultVertexWithPhongAndTC() = default;
@@ -218,58 +95,6 @@ public:
 		tocamera(tocamera),
 		pos(pos)
 	{}
-	DefaultVertexWithPhongAndTC& operator+=(const DefaultVertexWithPhongAndTC& rhs)
-	{
-		pos += rhs.pos;
-		tolightsrc += rhs.tolightsrc;
-		tocamera += rhs.tocamera;
-		normal += rhs.normal;
-		t += rhs.t;
-		return *this;
-	}
-	DefaultVertexWithPhongAndTC operator+(const DefaultVertexWithPhongAndTC& rhs) const
-	{
-		return DefaultVertexWithPhongAndTC(*this) += rhs;
-	}
-	DefaultVertexWithPhongAndTC& operator-=(const DefaultVertexWithPhongAndTC& rhs)
-	{
-		pos -= rhs.pos;
-		tolightsrc -= rhs.tolightsrc;
-		tocamera -= rhs.tocamera;
-		normal -= rhs.normal;
-		t -= rhs.t;
-		return *this;
-	}
-	DefaultVertexWithPhongAndTC operator-(const DefaultVertexWithPhongAndTC& rhs) const
-	{
-		return DefaultVertexWithPhongAndTC(*this) -= rhs;
-	}
-	DefaultVertexWithPhongAndTC& operator*=(float rhs)
-	{
-		pos *= rhs;
-		tolightsrc *= rhs;
-		tocamera *= rhs;
-		normal *= rhs;
-		t *= rhs;
-		return *this;
-	}
-	DefaultVertexWithPhongAndTC operator*(float rhs) const
-	{
-		return DefaultVertexWithPhongAndTC(*this) *= rhs;
-	}
-	DefaultVertexWithPhongAndTC& operator/=(float rhs)
-	{
-		pos /= rhs;
-		tolightsrc /= rhs;
-		tocamera /= rhs;
-		normal /= rhs;
-		t /= rhs;
-		return *this;
-	}
-	DefaultVertexWithPhongAndTC operator/(float rhs) const
-	{
-		return DefaultVertexWithPhongAndTC(*this) /= rhs;
-	}
 public:
 	Vec3 pos;
 	Vec3 tolightsrc;
@@ -15,12 +15,11 @@ public:
 	typedef Pipeline<WaveVertexTextureEffect> Pipeline;
 	typedef Pipeline::Vertex Vertex;
 public:
-	VertexWaveScene(Graphics& gfx)
+	VertexWaveScene(RenderTarget& gfx)
 		:
 		itlist(Plane::GetSkinned<Vertex>(20)),
-		zb(gfx.ScreenWidth, gfx.ScreenHeight),
-		sb(gfx.ScreenWidth, gfx.ScreenHeight),
-		pipeline(gfx, zb, sb),
+		dsb(gfx.GetWidth(), gfx.GetHeight()),
+		pipeline(gfx, dsb),
 		Scene("Test Plane Rippling VS")
 	{
 		pipeline.effect.ps.BindTexture(L"images\\sauron-bhole-100x100.png");
@@ -136,8 +135,7 @@ public:
 private:
 	IndexedTriangleList<Vertex> itlist;
 	Pipeline pipeline;
-	WBuffer zb;
-	StencilBuffer sb;
+	DepthStencilBuffer dsb;
 
 	static constexpr float dTheta = PI;
 	float offset_x = +0.0f;
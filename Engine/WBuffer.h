@@ -2,6 +2,9 @@
 
 #include <limits>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "ClearTags.h"
 
 class WBuffer
 {
@@ -12,7 +15,8 @@ public:
 		enableEqualTest(false),
 		width( width ),
 		height( height ),
-		pBuffer( new float[width*height] )
+		pBuffer( new float[width*height] ),
+		tags( width,height )
 	{}
 	~WBuffer()
 	{
@@ -21,10 +25,10 @@ public:
 	}
 	WBuffer( const WBuffer& ) = delete;
 	WBuffer& operator=( const WBuffer& ) = delete;
+	// lazy, spans get their zeros the first time they are touched
 	void Clear()
 	{
-		const int nDepths = width * height;
-		memset(pBuffer, 0, nDepths * sizeof(float));
+		tags.Clear();
 	}
 	float& At( int x,int y )
 	{
@@ -32,7 +36,12 @@ public:
 	//	assert( x < width );
 	//	assert( y >= 0 );
 	//	assert( y < height );
-		return pBuffer[y * width + x];
+		float* const pLine = pBuffer + y * width;
+		tags.Validate( x,y,[pLine]( int xFirst,int count )
+		{
+			std::fill( pLine + xFirst,pLine + xFirst + count,0.0f );
+		});
+		return pLine[x];
 	}
 	const float& At( int x,int y ) const
 	{
@@ -50,6 +59,19 @@ public:
 		}
 		return false;
 	}
+	// the same test with the switches fixed at compile time
+	template<bool set,bool equalTest>
+	bool TestAndSet( int x,int y,float depth )
+	{
+		float& depthInBuffer = At( x,y );
+		if( depth < depthInBuffer || (equalTest && depth == depthInBuffer) )
+		{
+			if( set )
+				depthInBuffer = depth;
+			return true;
+		}
+		return false;
+	}
 
 public:
 	bool enableEqualTest;
@@ -58,4 +80,5 @@ private:
 	int width;
 	int height;
 	float* pBuffer = nullptr;
+	ClearTags tags;
 };
\ No newline at end of file
@@ -11,6 +11,19 @@ class WBufferCreationEffect
 public:
 	typedef DefaultVertex Vertex;
 
+public:
+	// depth only pass, the pixel shader never runs
+	class Traits : public DefaultEffectTraits
+	{
+	public:
+		static constexpr DepthTest depthTest = DepthTest::Less;
+		static constexpr Toggle depthWrite = Toggle::On;
+		static constexpr Toggle colorWrite = Toggle::Off;
+		static constexpr CullMode cullMode = CullMode::Back;
+		static constexpr StencilOp stencilOp = StencilOp::Keep;
+		static constexpr bool needsAttributes = false;
+	};
+
 public:
 	// default vs rotates and translates vertices
 	// does not touch attributes
@@ -1,13 +1,15 @@
 #pragma once
 
 #include "Pipeline.h"
+#include "AssetRegistry.h"
 #include "IndexedTriangleList.h"
 #include "DefaultGeometryShader.h"
+#include "AttributePack.h"
 
 class WaveVertexTextureEffect
 {
 public:
-	class Vertex
+	class Vertex : public AttributePack<Vertex,Vec3,Vec2>
 	{
 	public:
 		Vertex() = default;
@@ -25,46 +27,6 @@ public:
 			t(t),
 			pos(pos)
 		{}
-		Vertex& operator+=(const Vertex& rhs)
-		{
-			pos += rhs.pos;
-			t += rhs.t;
-			return *this;
-		}
-		Vertex operator+(const Vertex& rhs) const
-		{
-			return Vertex(*this) += rhs;
-		}
-		Vertex& operator-=(const Vertex& rhs)
-		{
-			pos -= rhs.pos;
-			t -= rhs.t;
-			return *this;
-		}
-		Vertex operator-(const Vertex& rhs) const
-		{
-			return Vertex(*this) -= rhs;
-		}
-		Vertex& operator*=(float rhs)
-		{
-			pos *= rhs;
-			t *= rhs;
-			return *this;
-		}
-		Vertex operator*(float rhs) const
-		{
-			return Vertex(*this) *= rhs;
-		}
-		Vertex& operator/=(float rhs)
-		{
-			pos /= rhs;
-			t /= rhs;
-			return *this;
-		}
-		Vertex operator/(float rhs) const
-		{
-			return Vertex(*this) /= rhs;
-		}
 	public:
 		Vec3 pos;
 		Vec2 t;
@@ -138,16 +100,17 @@ public:
 				std::min((unsigned int)(in.t.y * tex_height + 0.5f), tex_yclamp)
 			);
 		}
+		// the texture of the file, shared with everything else that binds it
 		void BindTexture(const std::wstring& filename)
 		{
-			pTex = std::make_unique<Surface>(Surface::FromFile(filename));
+			pTex = AssetRegistry::GetTexture(filename);
 			tex_width = float(pTex->GetWidth());
 			tex_height = float(pTex->GetHeight());
 			tex_xclamp = (pTex->GetWidth() - 1);
 			tex_yclamp = (pTex->GetHeight() - 1);
 		}
 	private:
-		std::unique_ptr<Surface> pTex;
+		std::shared_ptr<const Surface> pTex;
 		float tex_width;
 		float tex_height;
 		unsigned int tex_xclamp;